@@ -0,0 +1,252 @@
+#include "AssetManager.h"
+#include "LoadProfiler.h"
+#include "Sounds.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+namespace {
+    // Niveles finos de textura que se suben por frame (ver TextureCache::stream)
+    const size_t STREAM_BYTES_PER_FRAME = 4 * 1024 * 1024;
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Tamaño en disco (MB) para repartir la barra de progreso entre recursos
+    float diskWeight(const std::vector<std::filesystem::path>& files) {
+        uintmax_t bytes = 0;
+        for (const auto& file : files) {
+            std::error_code ec;
+            uintmax_t size = std::filesystem::file_size(file, ec);
+            if (!ec)
+                bytes += size;
+        }
+        return std::max(0.1f, static_cast<float>(bytes) / (1024.0f * 1024.0f));
+    }
+
+    template <typename T>
+    bool isReady(const std::future<T>& future) {
+        return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    struct ModelRecord : TypedAssetRecord<Model> {
+        ModelSource source;
+        std::atomic<float> importProgress{ 0.0f };
+        std::future<bool> imported;
+        std::shared_ptr<TextureBatch> textures;
+
+        bool pump(double budgetMs) override {
+            if (state == AssetState::Queued || state == AssetState::Loading) {
+                if (!isReady(imported)) {
+                    progress = 0.6f * importProgress.load();
+                    return false;
+                }
+                if (!imported.get()) {
+                    std::cerr << "AssetManager: no se pudo cargar " << name << std::endl;
+                    state = AssetState::Failed;
+                    return true;
+                }
+
+                // Las texturas se decodifican con la misma prioridad que el modelo
+                textures = TextureCache::instance().prefetchAsync(source.texturePaths, static_cast<int>(priority));
+                object = std::make_unique<Model>();
+                state = AssetState::Uploading;
+            }
+
+            if (!textures->done()) {
+                progress = 0.6f + 0.3f * textures->progress();
+                return false;
+            }
+
+            if (!object->upload(source, budgetMs)) {
+                progress = 0.9f;
+                return false;
+            }
+
+            // La geometría ya está en la GPU: soltar la copia en CPU y la proyección
+            source.imported.clear();
+            source.cached.clear();
+            source.cache.close();
+
+            progress = 1.0f;
+            state = AssetState::Resident;
+            return true;
+        }
+
+        void wait() override {
+            if (imported.valid())
+                imported.wait();
+        }
+    };
+
+    struct SkyboxRecord : TypedAssetRecord<Skybox> {
+        std::unique_ptr<CubemapFaces> faces = std::make_unique<CubemapFaces>();
+        std::future<void> decoded;
+
+        bool pump(double) override {
+            if (!isReady(decoded))
+                return false;
+
+            object = std::make_unique<Skybox>(*faces);
+            faces.reset();
+            progress = 1.0f;
+            state = AssetState::Resident;
+            return true;
+        }
+
+        void wait() override {
+            if (decoded.valid())
+                decoded.wait();
+        }
+    };
+
+    struct SoundRecord : TypedAssetRecord<SoundBuffer> {
+        ALuint buffer = 0;
+        std::future<bool> loaded;
+
+        bool pump(double) override {
+            if (!isReady(loaded))
+                return false;
+
+            if (!loaded.get()) {
+                std::cerr << "Advertencia: No se pudo cargar " << name << "\n";
+                state = AssetState::Failed;
+                return true;
+            }
+
+            object = std::make_unique<SoundBuffer>();
+            object->buffer = buffer;
+            progress = 1.0f;
+            state = AssetState::Resident;
+            return true;
+        }
+
+        void wait() override {
+            if (loaded.valid())
+                loaded.wait();
+        }
+    };
+}
+
+AssetManager::~AssetManager() {
+    // Los hilos de trabajo escriben dentro de los registros: esperar antes de soltarlos
+    for (auto& record : records)
+        record->wait();
+}
+
+AssetHandle<Model> AssetManager::loadModel(const std::string& path, VertexFormat format, AssetPriority priority, bool required) {
+    auto record = std::make_shared<ModelRecord>();
+    record->name = path;
+    record->priority = priority;
+    record->required = required;
+    record->weight = diskWeight({ path, std::filesystem::path(path).replace_extension(".bin") });
+
+    ModelRecord* raw = record.get();
+    record->imported = ThreadPool::shared().submit([raw, format] {
+        raw->state = AssetState::Loading;
+        return Model::import(raw->name, format, raw->source, &raw->importProgress);
+    }, static_cast<int>(priority));
+
+    records.push_back(record);
+    return AssetHandle<Model>(record);
+}
+
+AssetHandle<Skybox> AssetManager::loadSkybox(const std::vector<std::string>& faces, AssetPriority priority, bool required) {
+    auto record = std::make_shared<SkyboxRecord>();
+    record->name = "skybox";
+    record->priority = priority;
+    record->required = required;
+    record->weight = diskWeight(std::vector<std::filesystem::path>(faces.begin(), faces.end()));
+
+    SkyboxRecord* raw = record.get();
+    record->decoded = ThreadPool::shared().submit([raw, faces] {
+        raw->state = AssetState::Loading;
+        Skybox::decodeFaces(faces, *raw->faces, &raw->progress);
+    }, static_cast<int>(priority));
+
+    records.push_back(record);
+    return AssetHandle<Skybox>(record);
+}
+
+AssetHandle<SoundBuffer> AssetManager::loadSound(const std::string& path, AssetPriority priority, bool required) {
+    auto record = std::make_shared<SoundRecord>();
+    record->name = path;
+    record->priority = priority;
+    record->required = required;
+    record->weight = diskWeight({ path });
+
+    // OpenAL no depende del contexto de OpenGL: el .wav se carga entero en el hilo de trabajo
+    SoundRecord* raw = record.get();
+    record->loaded = ThreadPool::shared().submit([raw] {
+        raw->state = AssetState::Loading;
+        ScopedTimer timer("WAV", raw->name);
+        return LoadWavFile(raw->name, raw->buffer);
+    }, static_cast<int>(priority));
+
+    records.push_back(record);
+    return AssetHandle<SoundBuffer>(record);
+}
+
+void AssetManager::update(double budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Primero las texturas ya decodificadas, luego cada recurso por prioridad
+    TextureCache::instance().uploadReady(budgetMs * 0.5);
+
+    std::vector<AssetRecord*> pending;
+    for (auto& record : records) {
+        AssetState state = record->state.load();
+        if (state != AssetState::Resident && state != AssetState::Failed)
+            pending.push_back(record.get());
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const AssetRecord* a, const AssetRecord* b) {
+        return a->priority < b->priority;
+    });
+
+    for (AssetRecord* record : pending) {
+        double remaining = budgetMs - elapsedMs(start);
+        if (remaining <= 0.0)
+            break;
+        record->pump(remaining);
+    }
+
+    // Al final, los mipmaps grandes; siempre con un mínimo para que avancen durante la carga
+    TextureCache::instance().stream(STREAM_BYTES_PER_FRAME, std::max(budgetMs - elapsedMs(start), budgetMs * 0.25));
+}
+
+float AssetManager::progress() const {
+    float done = 0.0f;
+    float total = 0.0f;
+    for (const auto& record : records) {
+        float value = record->state == AssetState::Failed ? 1.0f : record->progress.load();
+        done += record->weight * value;
+        total += record->weight;
+    }
+    return total > 0.0f ? done / total : 1.0f;
+}
+
+bool AssetManager::requiredReady() const {
+    for (const auto& record : records) {
+        AssetState state = record->state.load();
+        if (record->required && state != AssetState::Resident && state != AssetState::Failed)
+            return false;
+    }
+    return true;
+}
+
+std::string AssetManager::currentName() const {
+    const AssetRecord* current = nullptr;
+    for (const auto& record : records) {
+        AssetState state = record->state.load();
+        if (state == AssetState::Resident || state == AssetState::Failed)
+            continue;
+        if (!current || record->priority < current->priority)
+            current = record.get();
+    }
+    return current ? current->name : std::string();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <AL/al.h>
+#include "Model.h"
+#include "TextureCache.h"
+#include "skybox.h"
+
+// Menor número = se carga antes
+enum class AssetPriority : int {
+    Critical = 0,
+    High = 1,
+    Normal = 2,
+    Low = 3
+};
+
+enum class AssetState {
+    Queued,      // esperando un hilo de trabajo
+    Loading,     // importando/decodificando en CPU
+    Uploading,   // subiendo a la GPU desde el hilo principal
+    Resident,    // listo para usar
+    Failed
+};
+
+// Buffer de OpenAL cargado desde un .wav
+struct SoundBuffer {
+    ALuint buffer = 0;
+};
+
+// Estado compartido de un recurso; los hilos de trabajo solo tocan progress/state
+struct AssetRecord {
+    std::string name;
+    AssetPriority priority = AssetPriority::Normal;
+    bool required = false;
+    float weight = 1.0f;                    // peso en la barra de progreso (MB en disco)
+    std::atomic<AssetState> state{ AssetState::Queued };
+    std::atomic<float> progress{ 0.0f };    // 0..1 del recurso completo
+
+    virtual ~AssetRecord() = default;
+
+    // Hilo de OpenGL: avanza la subida; true cuando ya no queda nada que hacer
+    virtual bool pump(double budgetMs) = 0;
+    // Espera a que termine el trabajo en CPU (al destruir el gestor)
+    virtual void wait() = 0;
+};
+
+template <typename T>
+struct TypedAssetRecord : AssetRecord {
+    std::unique_ptr<T> object;
+};
+
+// Referencia a un recurso que puede no estar cargado todavía
+template <typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<TypedAssetRecord<T>> record) : record(std::move(record)) {}
+
+    T* get() const { return ready() ? record->object.get() : nullptr; }
+    bool ready() const { return record && record->state.load() == AssetState::Resident; }
+    AssetState state() const { return record ? record->state.load() : AssetState::Failed; }
+    float progress() const { return record ? record->progress.load() : 0.0f; }
+
+private:
+    std::shared_ptr<TypedAssetRecord<T>> record;
+};
+
+// Carga modelos, skybox y sonidos en segundo plano. Los hilos de trabajo hacen
+// la parte de CPU (Assimp/caché, decodificar imágenes, leer .wav) y update()
+// sube a la GPU desde el hilo principal con un presupuesto por frame.
+class AssetManager {
+public:
+    AssetManager() = default;
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // format: layout de vértices que espera el shader que va a dibujar el modelo
+    AssetHandle<Model> loadModel(const std::string& path, VertexFormat format, AssetPriority priority, bool required = true);
+    AssetHandle<Skybox> loadSkybox(const std::vector<std::string>& faces, AssetPriority priority, bool required = true);
+    AssetHandle<SoundBuffer> loadSound(const std::string& path, AssetPriority priority, bool required = false);
+
+    // Llamar una vez por frame desde el hilo de OpenGL (también después de
+    // terminar la carga: sigue subiendo los mipmaps grandes de las texturas)
+    void update(double budgetMs);
+
+    // Progreso ponderado de todos los recursos (0..1)
+    float progress() const;
+    // Todos los recursos requeridos están residentes (o fallaron y no se van a cargar)
+    bool requiredReady() const;
+    // Nombre del recurso que se está cargando ahora (para la barra)
+    std::string currentName() const;
+
+private:
+    std::vector<std::shared_ptr<AssetRecord>> records;
+};
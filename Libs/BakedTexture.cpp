@@ -0,0 +1,101 @@
+#include "BakedTexture.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    const char MAGIC[4] = { 'S', 'T', 'T', 'X' };
+
+    struct BakedHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipCount;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t dataSize;
+    };
+
+    struct BakedMipRecord {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+    };
+}
+
+bool BakedSource::stamp(const std::string& path, BakedSource& source) {
+    std::error_code ec;
+    source.size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    source.time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+std::string BakedTexture::bakedPath(const std::string& sourcePath) {
+    return sourcePath + ".sttex";
+}
+
+bool BakedTexture::load(const std::string& path, const BakedSource& source) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    BakedHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    // Si el archivo fuente cambió de tamaño o de fecha, hay que volver a hornear
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.sourceSize != source.size || header.sourceTime != source.time || header.mipCount == 0)
+        return false;
+
+    std::vector<BakedMipRecord> records(header.mipCount);
+    if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(BakedMipRecord)))
+        return false;
+
+    data.resize(header.dataSize);
+    if (!in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+        return false;
+
+    format = static_cast<BakedFormat>(header.format);
+    width = header.width;
+    height = header.height;
+    mips.clear();
+    for (const auto& record : records) {
+        if (record.offset + record.size > data.size())
+            return false;
+        mips.push_back(BakedMipLevel{ record.width, record.height, static_cast<size_t>(record.offset), static_cast<size_t>(record.size) });
+    }
+    return true;
+}
+
+bool BakedTexture::save(const std::string& path, const BakedSource& source) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    BakedHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.width = width;
+    header.height = height;
+    header.mipCount = static_cast<uint32_t>(mips.size());
+    header.sourceSize = source.size;
+    header.sourceTime = source.time;
+    header.dataSize = data.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& mip : mips) {
+        BakedMipRecord record = { mip.width, mip.height, mip.offset, mip.size };
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
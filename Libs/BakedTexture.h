@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formatos de bloque que produce SpeedTitansTexBake
+enum class BakedFormat : uint32_t {
+    BC1 = 1,   // RGB sin alfa, 4 bits por texel
+    BC3 = 3,   // RGBA, 8 bits por texel
+    BC5 = 5    // RG (mapas de normales), 8 bits por texel
+};
+
+struct BakedMipLevel {
+    uint32_t width;
+    uint32_t height;
+    size_t offset;   // dentro de BakedTexture::data
+    size_t size;
+};
+
+// Archivo fuente de un .sttex: tamaño y fecha de modificación, para saber si
+// se editó o se volvió a exportar después de hornearlo
+struct BakedSource {
+    uint64_t size = 0;
+    int64_t time = 0;
+
+    // false si el archivo no existe
+    static bool stamp(const std::string& path, BakedSource& source);
+};
+
+// Textura comprimida por bloques con su cadena de mipmaps completa (archivo .sttex)
+struct BakedTexture {
+    static const uint32_t VERSION = 2;
+
+    BakedFormat format = BakedFormat::BC1;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<BakedMipLevel> mips;
+    std::vector<unsigned char> data;
+
+    // "textures/x.jpeg" -> "textures/x.jpeg.sttex"
+    static std::string bakedPath(const std::string& sourcePath);
+
+    // Carga el archivo horneado si existe y corresponde al archivo fuente
+    bool load(const std::string& path, const BakedSource& source);
+    bool save(const std::string& path, const BakedSource& source) const;
+
+    // Memoria de vídeo de toda la cadena de mipmaps
+    size_t byteSize() const { return data.size(); }
+};
+
+namespace BlockCompression {
+    // Bloques de 4x4 texels RGBA8 (64 bytes, fila por fila)
+    void encodeBC1(const unsigned char* rgba, unsigned char* out);   // 8 bytes
+    void encodeBC3(const unsigned char* rgba, unsigned char* out);   // 16 bytes
+    void encodeBC5(const unsigned char* rgba, unsigned char* out);   // 16 bytes
+    void encodeBC4(const unsigned char* values, unsigned char* out); // 8 bytes, un canal
+
+    // Comprime una imagen RGBA8 completa y agrega los bloques al final de out
+    void compressImage(const unsigned char* rgba, int width, int height, BakedFormat format, std::vector<unsigned char>& out);
+
+    // Siguiente nivel de mipmap con filtro de caja 2x2 (channels bytes por texel)
+    std::vector<unsigned char> downsample(const unsigned char* pixels, int width, int height, int channels = 4);
+
+    size_t blockBytes(BakedFormat format);
+}
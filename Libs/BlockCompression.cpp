@@ -0,0 +1,293 @@
+#include "BakedTexture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    struct Color565 {
+        uint16_t packed;
+        int rgb[3];
+    };
+
+    Color565 quantize565(const float c[3]) {
+        int r = std::clamp(static_cast<int>(std::lround(c[0] * 31.0f / 255.0f)), 0, 31);
+        int g = std::clamp(static_cast<int>(std::lround(c[1] * 63.0f / 255.0f)), 0, 63);
+        int b = std::clamp(static_cast<int>(std::lround(c[2] * 31.0f / 255.0f)), 0, 31);
+
+        Color565 color;
+        color.packed = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        color.rgb[0] = (r << 3) | (r >> 2);
+        color.rgb[1] = (g << 2) | (g >> 4);
+        color.rgb[2] = (b << 3) | (b >> 2);
+        return color;
+    }
+
+    // Asigna a cada texel el color más cercano de la paleta de 4 entradas; devuelve el error
+    int chooseIndices(const unsigned char* rgba, const Color565& c0, const Color565& c1, uint32_t& indices) {
+        int palette[4][3];
+        for (int k = 0; k < 3; k++) {
+            palette[0][k] = c0.rgb[k];
+            palette[1][k] = c1.rgb[k];
+            palette[2][k] = (2 * c0.rgb[k] + c1.rgb[k]) / 3;
+            palette[3][k] = (c0.rgb[k] + 2 * c1.rgb[k]) / 3;
+        }
+
+        int totalError = 0;
+        indices = 0;
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = 1 << 30;
+            for (int p = 0; p < 4; p++) {
+                int dr = rgba[i * 4 + 0] - palette[p][0];
+                int dg = rgba[i * 4 + 1] - palette[p][1];
+                int db = rgba[i * 4 + 2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Ajuste por mínimos cuadrados de los extremos para unos índices dados
+    bool refineEndpoints(const unsigned char* rgba, uint32_t indices, float e0[3], float e1[3]) {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+        float aa = 0, ab = 0, bb = 0;
+        float ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; i++) {
+            float a = weights[(indices >> (2 * i)) & 3];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int k = 0; k < 3; k++) {
+                ax[k] += a * rgba[i * 4 + k];
+                bx[k] += b * rgba[i * 4 + k];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+
+        for (int k = 0; k < 3; k++) {
+            e0[k] = std::clamp((ax[k] * bb - bx[k] * ab) / det, 0.0f, 255.0f);
+            e1[k] = std::clamp((bx[k] * aa - ax[k] * ab) / det, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    void writeColorBlock(const Color565& c0, const Color565& c1, uint32_t indices, unsigned char* out) {
+        out[0] = static_cast<unsigned char>(c0.packed & 0xFF);
+        out[1] = static_cast<unsigned char>(c0.packed >> 8);
+        out[2] = static_cast<unsigned char>(c1.packed & 0xFF);
+        out[3] = static_cast<unsigned char>(c1.packed >> 8);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFF);
+    }
+
+    // Bloque de color BC1 en modo de 4 colores (c0 > c1)
+    void encodeColorBlock(const unsigned char* rgba, unsigned char* out) {
+        // Eje principal de los colores del bloque (iteración de potencia sobre la covarianza)
+        float mean[3] = {};
+        for (int i = 0; i < 16; i++)
+            for (int k = 0; k < 3; k++)
+                mean[k] += rgba[i * 4 + k] / 16.0f;
+
+        float cov[6] = {};
+        for (int i = 0; i < 16; i++) {
+            float d[3] = { rgba[i * 4] - mean[0], rgba[i * 4 + 1] - mean[1], rgba[i * 4 + 2] - mean[2] };
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iter = 0; iter < 8; iter++) {
+            float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            float len = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+            if (len < 1e-6f)
+                break;
+            axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+        }
+        float axisLen = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        for (float& a : axis)
+            a /= axisLen;
+
+        float tMin = 1e9f, tMax = -1e9f;
+        for (int i = 0; i < 16; i++) {
+            float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+
+        // Extremos metidos 1/16 hacia dentro para repartir mejor el error
+        float inset = (tMax - tMin) / 16.0f;
+        float e0[3], e1[3];
+        for (int k = 0; k < 3; k++) {
+            e0[k] = std::clamp(mean[k] + axis[k] * (tMax - inset), 0.0f, 255.0f);
+            e1[k] = std::clamp(mean[k] + axis[k] * (tMin + inset), 0.0f, 255.0f);
+        }
+
+        Color565 c0 = quantize565(e0);
+        Color565 c1 = quantize565(e1);
+        if (c0.packed < c1.packed)
+            std::swap(c0, c1);
+
+        if (c0.packed == c1.packed) {
+            // Bloque plano: todos los índices a c0
+            writeColorBlock(c0, c1, 0, out);
+            return;
+        }
+
+        uint32_t indices;
+        int error = chooseIndices(rgba, c0, c1, indices);
+
+        // Una pasada de refinamiento; se queda solo si mejora
+        float r0[3], r1[3];
+        if (error > 0 && refineEndpoints(rgba, indices, r0, r1)) {
+            Color565 n0 = quantize565(r0);
+            Color565 n1 = quantize565(r1);
+            if (n0.packed < n1.packed)
+                std::swap(n0, n1);
+            if (n0.packed != n1.packed) {
+                uint32_t newIndices;
+                int newError = chooseIndices(rgba, n0, n1, newIndices);
+                if (newError < error) {
+                    c0 = n0;
+                    c1 = n1;
+                    indices = newIndices;
+                }
+            }
+        }
+
+        writeColorBlock(c0, c1, indices, out);
+    }
+}
+
+namespace BlockCompression {
+
+void encodeBC1(const unsigned char* rgba, unsigned char* out) {
+    encodeColorBlock(rgba, out);
+}
+
+void encodeBC4(const unsigned char* values, unsigned char* out) {
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = std::min(lo, static_cast<int>(values[i]));
+        hi = std::max(hi, static_cast<int>(values[i]));
+    }
+
+    // Modo de 8 valores: a0 > a1
+    out[0] = static_cast<unsigned char>(hi);
+    out[1] = static_cast<unsigned char>(lo);
+
+    uint64_t bits = 0;
+    if (hi != lo) {
+        int palette[8];
+        palette[0] = hi;
+        palette[1] = lo;
+        for (int k = 1; k <= 6; k++)
+            palette[k + 1] = ((7 - k) * hi + k * lo) / 7;
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = 1 << 30;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(values[i] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = static_cast<unsigned char>((bits >> (8 * i)) & 0xFF);
+}
+
+void encodeBC3(const unsigned char* rgba, unsigned char* out) {
+    unsigned char alpha[16];
+    for (int i = 0; i < 16; i++)
+        alpha[i] = rgba[i * 4 + 3];
+    encodeBC4(alpha, out);
+    encodeColorBlock(rgba, out + 8);
+}
+
+void encodeBC5(const unsigned char* rgba, unsigned char* out) {
+    unsigned char red[16], green[16];
+    for (int i = 0; i < 16; i++) {
+        red[i] = rgba[i * 4 + 0];
+        green[i] = rgba[i * 4 + 1];
+    }
+    encodeBC4(red, out);
+    encodeBC4(green, out + 8);
+}
+
+size_t blockBytes(BakedFormat format) {
+    return format == BakedFormat::BC1 ? 8 : 16;
+}
+
+void compressImage(const unsigned char* rgba, int width, int height, BakedFormat format, std::vector<unsigned char>& out) {
+    int blocksX = std::max(1, (width + 3) / 4);
+    int blocksY = std::max(1, (height + 3) / 4);
+    size_t stride = blockBytes(format);
+
+    size_t start = out.size();
+    out.resize(start + size_t(blocksX) * blocksY * stride);
+    unsigned char* dst = out.data() + start;
+
+    unsigned char block[64];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            // Copiar el bloque repitiendo el borde en niveles menores que 4x4
+            for (int y = 0; y < 4; y++) {
+                int sy = std::min(by * 4 + y, height - 1);
+                for (int x = 0; x < 4; x++) {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+
+            if (format == BakedFormat::BC1)
+                encodeBC1(block, dst);
+            else if (format == BakedFormat::BC3)
+                encodeBC3(block, dst);
+            else
+                encodeBC5(block, dst);
+            dst += stride;
+        }
+    }
+}
+
+std::vector<unsigned char> downsample(const unsigned char* pixels, int width, int height, int channels) {
+    int newWidth = std::max(1, width / 2);
+    int newHeight = std::max(1, height / 2);
+    std::vector<unsigned char> result(size_t(newWidth) * newHeight * channels);
+
+    for (int y = 0; y < newHeight; y++) {
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < newWidth; x++) {
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+            for (int k = 0; k < channels; k++) {
+                int sum = pixels[(size_t(y0) * width + x0) * channels + k] + pixels[(size_t(y0) * width + x1) * channels + k] +
+                          pixels[(size_t(y1) * width + x0) * channels + k] + pixels[(size_t(y1) * width + x1) * channels + k];
+                result[(size_t(y) * newWidth + x) * channels + k] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,318 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const int SAH_BINS = 12;
+    const float TRAVERSAL_COST = 1.0f;   // relativo a probar un elemento
+    const int MAX_DEPTH = 60;            // la pila de cull tiene lugar para MAX_DEPTH + 1
+
+    MeshBounds nodeBounds(const BvhNode& node) {
+        MeshBounds bounds;
+        bounds.min = glm::vec3(node.min[0], node.min[1], node.min[2]);
+        bounds.max = glm::vec3(node.max[0], node.max[1], node.max[2]);
+        return bounds;
+    }
+
+    void setBounds(BvhNode& node, const MeshBounds& bounds) {
+        for (int k = 0; k < 3; k++) {
+            node.min[k] = bounds.min[k];
+            node.max[k] = bounds.max[k];
+        }
+    }
+
+    // Los planos de CullView listos para probar cajas de a una
+    struct PlaneSet {
+        glm::vec4 planes[CullView::PlaneCount];
+        glm::vec3 absNormals[CullView::PlaneCount];
+        float radiusScale;
+        float minPixels;
+        float objectScale;
+
+        explicit PlaneSet(const CullView& view) {
+            for (int i = 0; i < CullView::PlaneCount; i++) {
+                planes[i] = view.planes[i];
+                absNormals[i] = glm::abs(glm::vec3(view.planes[i]));
+            }
+            radiusScale = 2.0f * view.pixelScale * view.objectScale;
+            minPixels = view.minPixels;
+            objectScale = view.objectScale;
+        }
+
+        // false si la caja queda detrás de algún plano de mask; si no, saca de
+        // mask los planos que tiene enteros adelante (los hijos no los prueban)
+        bool test(const glm::vec3& center, const glm::vec3& extent, uint32_t& mask) const {
+            for (int i = 0; i < CullView::PlaneCount; i++) {
+                if (!(mask & (1u << i)))
+                    continue;
+                float d = glm::dot(glm::vec3(planes[i]), center) + planes[i].w;
+                float r = glm::dot(absNormals[i], extent);
+                if (d + r < 0.0f)
+                    return false;
+                if (d - r >= 0.0f)
+                    mask &= ~(1u << i);
+            }
+            return true;
+        }
+
+        float nearDistance(const glm::vec3& center) const {
+            const glm::vec4& nearPlane = planes[CullView::Near];
+            return glm::dot(glm::vec3(nearPlane), center) + nearPlane.w;
+        }
+
+        // El mismo criterio que cullBounds
+        bool tooSmall(const glm::vec3& center, float radius) const {
+            return minPixels > 0.0f && radius * radiusScale < minPixels * nearDistance(center);
+        }
+
+        // Todo lo que hay adentro de la esfera es chico según tooSmall: ningún
+        // elemento es más grande que ella ni está más cerca que su borde
+        bool allTooSmall(const glm::vec3& center, float radius) const {
+            return minPixels > 0.0f && radius * radiusScale < minPixels * (nearDistance(center) - radius * objectScale);
+        }
+    };
+}
+
+void Bvh::build(const std::vector<MeshBounds>& bounds) {
+    nodes.clear();
+    items.clear();
+    leafBounds.clear();
+    cost = builtCost = 0.0f;
+    if (bounds.empty())
+        return;
+
+    std::vector<BuildItem> work(bounds.size());
+    for (size_t i = 0; i < bounds.size(); i++)
+        work[i] = BuildItem{ bounds[i], bounds[i].center(), static_cast<uint32_t>(i) };
+
+    nodes.reserve(2 * bounds.size());
+    buildNode(work, 0, static_cast<uint32_t>(work.size()), 0);
+
+    items.reserve(work.size());
+    leafBounds.reserve(work.size());
+    for (const BuildItem& item : work) {
+        items.push_back(item.index);
+        leafBounds.push_back(item.bounds);
+    }
+    cost = builtCost = computeCost();
+}
+
+uint32_t Bvh::buildNode(std::vector<BuildItem>& work, uint32_t first, uint32_t count, int depth) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    MeshBounds bounds = work[first].bounds;
+    MeshBounds centroids{ work[first].centroid, work[first].centroid };
+    for (uint32_t i = first + 1; i < first + count; i++) {
+        bounds.merge(work[i].bounds);
+        centroids.merge(MeshBounds{ work[i].centroid, work[i].centroid });
+    }
+    setBounds(nodes[index], bounds);
+
+    if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH) {
+        nodes[index].leftOrFirst = first;
+        nodes[index].count = count;
+        return index;
+    }
+
+    // SAH en cubetas: por cada eje, SAH_BINS cubetas a lo largo de los centroides
+    // y SAH_BINS - 1 cortes posibles entre ellas
+    float bestCost = std::numeric_limits<float>::infinity();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        float low = centroids.min[axis];
+        float extent = centroids.max[axis] - low;
+        if (extent <= 1e-6f)
+            continue;
+
+        MeshBounds binBounds[SAH_BINS];
+        uint32_t binCount[SAH_BINS] = {};
+        float scale = SAH_BINS / extent;
+        for (uint32_t i = first; i < first + count; i++) {
+            int bin = std::min(SAH_BINS - 1, static_cast<int>((work[i].centroid[axis] - low) * scale));
+            if (binCount[bin]++ == 0)
+                binBounds[bin] = work[i].bounds;
+            else
+                binBounds[bin].merge(work[i].bounds);
+        }
+
+        // Área y cantidad a la izquierda de cada corte, y después a la derecha
+        float leftArea[SAH_BINS - 1];
+        uint32_t leftCount[SAH_BINS - 1];
+        MeshBounds accumulated;
+        uint32_t accumulatedCount = 0;
+        for (int split = 0; split < SAH_BINS - 1; split++) {
+            if (binCount[split] > 0) {
+                if (accumulatedCount == 0)
+                    accumulated = binBounds[split];
+                else
+                    accumulated.merge(binBounds[split]);
+                accumulatedCount += binCount[split];
+            }
+            leftArea[split] = accumulatedCount > 0 ? accumulated.surfaceArea() : 0.0f;
+            leftCount[split] = accumulatedCount;
+        }
+        accumulatedCount = 0;
+        for (int split = SAH_BINS - 2; split >= 0; split--) {
+            if (binCount[split + 1] > 0) {
+                if (accumulatedCount == 0)
+                    accumulated = binBounds[split + 1];
+                else
+                    accumulated.merge(binBounds[split + 1]);
+                accumulatedCount += binCount[split + 1];
+            }
+            if (leftCount[split] == 0 || accumulatedCount == 0)
+                continue;
+            float splitCost = leftArea[split] * leftCount[split] + accumulated.surfaceArea() * accumulatedCount;
+            if (splitCost < bestCost) {
+                bestCost = splitCost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t leftSize = 0;
+    if (bestAxis >= 0) {
+        float low = centroids.min[bestAxis];
+        float scale = SAH_BINS / (centroids.max[bestAxis] - low);
+        auto middle = std::partition(work.begin() + first, work.begin() + first + count, [&](const BuildItem& item) {
+            return std::min(SAH_BINS - 1, static_cast<int>((item.centroid[bestAxis] - low) * scale)) <= bestSplit;
+        });
+        leftSize = static_cast<uint32_t>(middle - (work.begin() + first));
+    }
+    if (leftSize == 0 || leftSize == count) {
+        // Todos los centroides en el mismo punto: cualquier mitad sirve
+        leftSize = count / 2;
+    }
+
+    buildNode(work, first, leftSize, depth + 1);   // queda en index + 1
+    uint32_t right = buildNode(work, first + leftSize, count - leftSize, depth + 1);
+    nodes[index].leftOrFirst = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+void Bvh::refit(const std::vector<MeshBounds>& bounds) {
+    for (size_t i = 0; i < items.size(); i++)
+        leafBounds[i] = bounds[items[i]];
+
+    // Los hijos siempre están después del padre: de atrás hacia adelante
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNode& node = nodes[i];
+        MeshBounds merged;
+        if (node.isLeaf()) {
+            merged = leafBounds[node.leftOrFirst];
+            for (uint32_t k = 1; k < node.count; k++)
+                merged.merge(leafBounds[node.leftOrFirst + k]);
+        } else {
+            merged = nodeBounds(nodes[i + 1]);
+            merged.merge(nodeBounds(nodes[node.leftOrFirst]));
+        }
+        setBounds(node, merged);
+    }
+    cost = computeCost();
+}
+
+// Costo SAH esperado de un recorrido, relativo al área de la raíz
+float Bvh::computeCost() const {
+    if (nodes.empty())
+        return 0.0f;
+    float rootArea = std::max(nodeBounds(nodes[0]).surfaceArea(), 1e-12f);
+    float total = 0.0f;
+    for (const BvhNode& node : nodes) {
+        float area = nodeBounds(node).surfaceArea();
+        total += node.isLeaf() ? area * node.count : area * TRAVERSAL_COST;
+    }
+    return total / rootArea;
+}
+
+// Los elementos de un subárbol son contiguos: van de la primera hoja
+// (bajando por la izquierda) al final de la última (bajando por la derecha)
+void Bvh::itemRange(uint32_t node, uint32_t& begin, uint32_t& end) const {
+    uint32_t left = node;
+    while (!nodes[left].isLeaf())
+        left = left + 1;
+    uint32_t right = node;
+    while (!nodes[right].isLeaf())
+        right = nodes[right].leftOrFirst;
+    begin = nodes[left].leftOrFirst;
+    end = nodes[right].leftOrFirst + nodes[right].count;
+}
+
+CullStats Bvh::cull(const CullView& view, VisibilityBits& visible) const {
+    CullStats stats;
+    stats.tested = items.size();
+    visible.resize(items.size(), false);
+    if (nodes.empty())
+        return stats;
+
+    PlaneSet planes(view);
+    const uint32_t ALL_PLANES = (1u << CullView::PlaneCount) - 1;
+    struct Entry {
+        uint32_t node;
+        uint32_t mask;   // planos que todavía cortan al padre
+    };
+    Entry stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = Entry{ 0, ALL_PLANES };
+
+    size_t visibleCount = 0;
+    while (top > 0) {
+        Entry entry = stack[--top];
+        const BvhNode& node = nodes[entry.node];
+        MeshBounds bounds = nodeBounds(node);
+        glm::vec3 center = bounds.center();
+        glm::vec3 extent = (bounds.max - bounds.min) * 0.5f;
+        stats.boxTests++;
+
+        uint32_t mask = entry.mask;
+        if (!planes.test(center, extent, mask))
+            continue;
+
+        // Subárbol entero adentro (sin planos que lo corten) o entero chico:
+        // sus elementos se resuelven sin bajar por los nodos
+        bool small = planes.allTooSmall(center, glm::length(extent));
+        if (mask == 0 || small) {
+            uint32_t begin, end;
+            itemRange(entry.node, begin, end);
+            for (uint32_t k = begin; k < end; k++) {
+                bool itemSmall = small || planes.tooSmall(leafBounds[k].center(), leafBounds[k].radius());
+                stats.small += itemSmall;
+                if (!itemSmall) {
+                    visible.set(items[k], true);
+                    visibleCount++;
+                }
+            }
+            continue;
+        }
+
+        if (node.isLeaf()) {
+            for (uint32_t k = node.leftOrFirst; k < node.leftOrFirst + node.count; k++) {
+                const MeshBounds& item = leafBounds[k];
+                glm::vec3 itemCenter = item.center();
+                uint32_t itemMask = mask;
+                stats.boxTests++;
+                if (!planes.test(itemCenter, (item.max - item.min) * 0.5f, itemMask))
+                    continue;
+                if (planes.tooSmall(itemCenter, item.radius())) {
+                    stats.small++;
+                    continue;
+                }
+                visible.set(items[k], true);
+                visibleCount++;
+            }
+            continue;
+        }
+
+        // El izquierdo arriba de la pila: se recorre en el orden del arreglo
+        stack[top++] = Entry{ node.leftOrFirst, mask };
+        stack[top++] = Entry{ entry.node + 1, mask };
+    }
+
+    stats.outside = stats.tested - visibleCount - stats.small;
+    return stats;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm.hpp>
+#include "Culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Nodo en el arreglo en profundidad: el hijo izquierdo va justo después del
+// padre y leftOrFirst apunta al derecho. En las hojas, leftOrFirst es el primer
+// elemento y count cuántos hay. Dos nodos por línea de caché.
+struct BvhNode {
+    float min[3];
+    uint32_t leftOrFirst;
+    float max[3];
+    uint32_t count;   // 0 = nodo interno
+
+    bool isLeaf() const { return count > 0; }
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode debe ocupar 32 bytes");
+
+// Jerarquía de cajas para hacer culling de subárboles enteros. Se construye con
+// SAH (heurística de área de superficie, en cubetas) y, cuando algo se mueve,
+// se reajusta con refit sin cambiar la topología; si el árbol se degrada
+// demasiado conviene reconstruirlo (needsRebuild).
+class Bvh {
+public:
+    // Elementos por hoja como máximo
+    static const uint32_t MAX_LEAF_SIZE = 4;
+
+    void build(const std::vector<MeshBounds>& bounds);
+    // Mismas cajas en el mismo orden, con valores nuevos
+    void refit(const std::vector<MeshBounds>& bounds);
+    // Costo SAH después de los refit comparado con el de la construcción
+    bool needsRebuild() const { return cost > builtCost * REBUILD_RATIO; }
+
+    // Prueba el árbol contra view y escribe un bit por elemento en visible (del
+    // tamaño de bounds). Un subárbol entero dentro de todos los planos no se
+    // vuelve a probar contra ellos; uno afuera se descarta sin bajar.
+    CullStats cull(const CullView& view, VisibilityBits& visible) const;
+
+    bool empty() const { return nodes.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t size() const { return items.size(); }
+
+private:
+    static constexpr float REBUILD_RATIO = 1.5f;
+
+    struct BuildItem {
+        MeshBounds bounds;
+        glm::vec3 centroid;
+        uint32_t index;
+    };
+
+    uint32_t buildNode(std::vector<BuildItem>& work, uint32_t first, uint32_t count, int depth);
+    float computeCost() const;
+    void itemRange(uint32_t node, uint32_t& begin, uint32_t& end) const;
+
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> items;          // índice original de cada elemento, en orden de hojas
+    std::vector<MeshBounds> leafBounds;   // sus cajas en el mismo orden (se leen seguidas)
+    float cost = 0.0f;
+    float builtCost = 0.0f;
+};
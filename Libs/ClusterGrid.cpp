@@ -0,0 +1,78 @@
+#include "ClusterGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+ClusterGrid ClusterGrid::fit(const MeshBounds& bounds, size_t triangles, const glm::vec3& facing) {
+    ClusterGrid grid;
+    if (triangles < MIN_TRIANGLES)
+        return grid;
+
+    // Los dos ejes más largos son el suelo; el tercero, la altura
+    glm::vec3 extent = bounds.max - bounds.min;
+    int up = 0;
+    for (int axis = 1; axis < 3; axis++) {
+        if (extent[axis] < extent[up])
+            up = axis;
+    }
+    grid.axisU = (up + 1) % 3;
+    grid.axisV = (up + 2) % 3;
+    grid.cellSize = std::max(extent[grid.axisU], extent[grid.axisV]) / static_cast<float>(CELLS);
+    grid.origin = bounds.min;
+    grid.upDirection[up] = facing[up] < 0.0f ? -1.0f : 1.0f;
+    return grid;
+}
+
+int ClusterGrid::cell(const glm::vec3& point) const {
+    auto index = [&](int axis) {
+        float f = std::floor((point[axis] - origin[axis]) / cellSize);
+        return static_cast<int>(std::clamp(f, 0.0f, static_cast<float>(CELLS - 1)));
+    };
+    return index(axisV) * static_cast<int>(CELLS) + index(axisU);
+}
+
+std::vector<ClusterGrid::Piece> ClusterGrid::split(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices) const {
+    // Triángulos agrupados por celda (orden estable: se conserva el de la malla)
+    size_t triangleCount = indices.size() / 3;
+    std::vector<int> triangleCell(triangleCount);
+    std::vector<size_t> cellStart(CELLS * CELLS + 1, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        glm::vec3 center = (vertices[indices[t * 3]].Position + vertices[indices[t * 3 + 1]].Position +
+                            vertices[indices[t * 3 + 2]].Position) / 3.0f;
+        triangleCell[t] = cell(center);
+        cellStart[triangleCell[t] + 1]++;
+    }
+    for (size_t c = 0; c < CELLS * CELLS; c++)
+        cellStart[c + 1] += cellStart[c];
+    std::vector<size_t> order(triangleCount);
+    std::vector<size_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+        order[cursor[triangleCell[t]]++] = t;
+
+    std::vector<Piece> pieces;
+    std::vector<GLuint> remap(vertices.size(), ~0u);
+    for (size_t c = 0; c < CELLS * CELLS; c++) {
+        if (cellStart[c] == cellStart[c + 1])
+            continue;
+        Piece piece;
+        piece.cell = static_cast<int>(c);
+        piece.indices.reserve((cellStart[c + 1] - cellStart[c]) * 3);
+        for (size_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+            for (int corner = 0; corner < 3; corner++) {
+                GLuint v = indices[order[k] * 3 + corner];
+                if (remap[v] == ~0u) {
+                    remap[v] = static_cast<GLuint>(piece.vertices.size());
+                    piece.vertices.push_back(vertices[v]);
+                }
+                piece.indices.push_back(remap[v]);
+            }
+        }
+        // remap solo vale dentro de la pieza
+        for (size_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+            for (int corner = 0; corner < 3; corner++)
+                remap[indices[order[k] * 3 + corner]] = ~0u;
+        }
+        pieces.push_back(std::move(piece));
+    }
+    return pieces;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Culling.h"
+#include "VertexLayout.h"
+
+// Celdas de un modelo grande (una ciudad) sobre el plano de sus dos ejes más
+// largos. Al importar, las mallas estáticas se parten por celda (cada triángulo
+// va a la de su centro): así el culling, los niveles de detalle y los
+// impostores (ver ImpostorAtlas) trabajan por barrio y no con mallas que
+// cruzan la ciudad entera. Solo CPU.
+class ClusterGrid {
+public:
+    static constexpr size_t CELLS = 8;                  // por lado
+    static constexpr size_t MIN_TRIANGLES = 200000;     // los modelos más chicos no se parten
+
+    // Parte de una malla que cae en una celda, con sus vértices renumerados
+    struct Piece {
+        int cell;
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+    };
+
+    // bounds y triangles: de todas las mallas estáticas; facing: suma de sus
+    // normales de cara por el área, para saber hacia dónde está el cielo.
+    // Sin celdas (valid() = false) si el modelo no llega a MIN_TRIANGLES.
+    static ClusterGrid fit(const MeshBounds& bounds, size_t triangles, const glm::vec3& facing);
+
+    bool valid() const { return cellSize > 0.0f; }
+    // El eje corto de la caja, con el signo hacia donde miran las caras
+    glm::vec3 up() const { return upDirection; }
+
+    int cell(const glm::vec3& point) const;
+
+    // Una pieza por celda que toca la malla, en orden de celda
+    std::vector<Piece> split(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices) const;
+
+private:
+    glm::vec3 origin = glm::vec3(0.0f);
+    float cellSize = 0.0f;
+    int axisU = 0, axisV = 1;
+    glm::vec3 upDirection = glm::vec3(0.0f);
+};
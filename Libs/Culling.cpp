@@ -0,0 +1,298 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// El ancho se elige al compilar: AVX con SPEEDTITANS_AVX (ver CMakeLists.txt),
+// SSE en cualquier x86-64 y el bucle escalar en el resto
+#if defined(__AVX__)
+#define CULL_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_SSE
+#include <emmintrin.h>
+#endif
+
+float MeshBounds::surfaceArea() const {
+    glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// Centro transformado y medio lado por el valor absoluto de la parte 3x3 (Arvo)
+MeshBounds MeshBounds::transformed(const glm::mat4& matrix) const {
+    glm::vec3 c = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+    glm::vec3 e = (max - min) * 0.5f;
+    glm::mat3 m(matrix);
+    glm::vec3 extent(0.0f);
+    for (int col = 0; col < 3; col++)
+        extent += glm::abs(m[col]) * e[col];
+    MeshBounds result;
+    result.min = c - extent;
+    result.max = c + extent;
+    return result;
+}
+
+CullView CullView::make(const glm::mat4& projection, const glm::mat4& view, float viewportHeight, float minPixels) {
+    glm::mat4 m = projection * view;
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    CullView result;
+    result.planes[Left] = row(3) + row(0);
+    result.planes[Right] = row(3) - row(0);
+    result.planes[Bottom] = row(3) + row(1);
+    result.planes[Top] = row(3) - row(1);
+    result.planes[Near] = row(3) + row(2);
+    result.planes[Far] = row(3) - row(2);
+    for (glm::vec4& plane : result.planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    // projection[1][1] = 1 / tan(fovy / 2)
+    result.pixelScale = projection[1][1] * viewportHeight * 0.5f;
+    result.minPixels = minPixels;
+    return result;
+}
+
+CullView CullView::toObject(const glm::mat4& model) const {
+    CullView result = *this;
+    for (int i = 0; i < PlaneCount; i++) {
+        const glm::vec4& p = planes[i];
+        result.planes[i] = glm::vec4(glm::dot(p, model[0]), glm::dot(p, model[1]), glm::dot(p, model[2]), glm::dot(p, model[3]));
+    }
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+    result.objectScale = objectScale * scale;
+    return result;
+}
+
+float CullView::nearDistance(const MeshBounds& box) const {
+    const glm::vec4& plane = planes[Near];
+    glm::vec3 extent = (box.max - box.min) * 0.5f;
+    return glm::dot(glm::vec3(plane), box.center()) + plane.w - glm::dot(glm::abs(glm::vec3(plane)), extent);
+}
+
+bool CullView::intersects(const MeshBounds& box) const {
+    glm::vec3 center = box.center();
+    glm::vec3 extent = (box.max - box.min) * 0.5f;
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w + glm::dot(glm::abs(glm::vec3(plane)), extent) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+void VisibilityBits::resize(size_t count, bool value) {
+    bitCount = count;
+    words.assign((count + 63) / 64, value ? ~0ull : 0ull);
+    if (value && (count & 63))
+        words.back() &= (1ull << (count & 63)) - 1;
+}
+
+void VisibilityBits::set(size_t i, bool value) {
+    uint64_t bit = 1ull << (i & 63);
+    if (value)
+        words[i >> 6] |= bit;
+    else
+        words[i >> 6] &= ~bit;
+}
+
+void VisibilityBits::setRange(size_t first, uint32_t mask, unsigned count) {
+    if (count == 0)
+        return;
+    uint64_t keep = count >= 32 ? 0xFFFFFFFFull : (1ull << count) - 1;
+    uint64_t bits = mask & keep;
+    size_t word = first >> 6;
+    unsigned shift = first & 63;
+    words[word] = (words[word] & ~(keep << shift)) | (bits << shift);
+    if (shift + count > 64) {
+        unsigned rest = 64 - shift;
+        words[word + 1] = (words[word + 1] & ~(keep >> rest)) | (bits >> rest);
+    }
+}
+
+size_t VisibilityBits::count() const {
+    size_t total = 0;
+    for (uint64_t word : words)
+        total += std::popcount(word);
+    return total;
+}
+
+void BoundsSoA::clear() {
+    for (auto* array : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius })
+        array->clear();
+}
+
+void BoundsSoA::reserve(size_t count) {
+    for (auto* array : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius })
+        array->reserve(count);
+}
+
+void BoundsSoA::add(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extent = (max - min) * 0.5f;
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extent.x);
+    extentY.push_back(extent.y);
+    extentZ.push_back(extent.z);
+    radius.push_back(glm::length(extent));
+}
+
+CullStats& CullStats::operator+=(const CullStats& other) {
+    tested += other.tested;
+    outside += other.outside;
+    small += other.small;
+    occluded += other.occluded;
+    softwareOccluded += other.softwareOccluded;
+    boxTests += other.boxTests;
+    return *this;
+}
+
+// Una caja está afuera si queda entera detrás de algún plano: centro + proyección
+// del medio lado sobre la normal < 0. Es chica si su esfera, a la distancia del
+// plano near (un poco menos que la profundidad real: nunca descarta de más),
+// mide menos de minPixels.
+struct CullKernel {
+    float nx[CullView::PlaneCount], ny[CullView::PlaneCount], nz[CullView::PlaneCount], nw[CullView::PlaneCount];
+    float ax[CullView::PlaneCount], ay[CullView::PlaneCount], az[CullView::PlaneCount];
+    float radiusScale;   // 2 * pixelScale * objectScale: diámetro en píxeles por unidad de radio y de distancia
+    float minPixels;
+
+    explicit CullKernel(const CullView& view) {
+        for (int i = 0; i < CullView::PlaneCount; i++) {
+            nx[i] = view.planes[i].x;
+            ny[i] = view.planes[i].y;
+            nz[i] = view.planes[i].z;
+            nw[i] = view.planes[i].w;
+            ax[i] = std::fabs(nx[i]);
+            ay[i] = std::fabs(ny[i]);
+            az[i] = std::fabs(nz[i]);
+        }
+        radiusScale = 2.0f * view.pixelScale * view.objectScale;
+        minPixels = view.minPixels;
+    }
+
+    // 0 visible, 1 afuera, 2 chica
+    int classify(const BoundsSoA& b, size_t i) const {
+        float nearDistance = 0.0f;
+        for (int p = 0; p < CullView::PlaneCount; p++) {
+            float d = nx[p] * b.centerX[i] + ny[p] * b.centerY[i] + nz[p] * b.centerZ[i] + nw[p];
+            float r = ax[p] * b.extentX[i] + ay[p] * b.extentY[i] + az[p] * b.extentZ[i];
+            if (d + r < 0.0f)
+                return 1;
+            if (p == CullView::Near)
+                nearDistance = d;
+        }
+        if (minPixels > 0.0f && b.radius[i] * radiusScale < minPixels * nearDistance)
+            return 2;
+        return 0;
+    }
+
+    void scalar(const BoundsSoA& b, size_t first, size_t end, CullStats& stats, VisibilityBits& visible) const {
+        for (size_t i = first; i < end; i++) {
+            int result = classify(b, i);
+            stats.outside += result == 1;
+            stats.small += result == 2;
+            visible.set(i, result == 0);
+        }
+    }
+
+#if defined(CULL_AVX)
+    static const size_t WIDTH = 8;
+
+    // Devuelve hasta dónde llegó; el resto queda para scalar
+    size_t vector(const BoundsSoA& b, size_t first, size_t end, CullStats& stats, VisibilityBits& visible) const {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 sizeScale = _mm256_set1_ps(radiusScale);
+        const __m256 minSize = _mm256_set1_ps(minPixels);
+        size_t i = first;
+        for (; i + WIDTH <= end; i += WIDTH) {
+            __m256 cx = _mm256_loadu_ps(&b.centerX[i]), cy = _mm256_loadu_ps(&b.centerY[i]), cz = _mm256_loadu_ps(&b.centerZ[i]);
+            __m256 ex = _mm256_loadu_ps(&b.extentX[i]), ey = _mm256_loadu_ps(&b.extentY[i]), ez = _mm256_loadu_ps(&b.extentZ[i]);
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            __m256 nearDistance = zero;
+            for (int p = 0; p < CullView::PlaneCount; p++) {
+                __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nx[p]), cx), _mm256_mul_ps(_mm256_set1_ps(ny[p]), cy)),
+                                         _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nz[p]), cz), _mm256_set1_ps(nw[p])));
+                __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ax[p]), ex), _mm256_mul_ps(_mm256_set1_ps(ay[p]), ey)),
+                                         _mm256_mul_ps(_mm256_set1_ps(az[p]), ez));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_GE_OQ));
+                if (p == CullView::Near)
+                    nearDistance = d;
+            }
+            unsigned insideMask = static_cast<unsigned>(_mm256_movemask_ps(inside));
+            unsigned smallMask = 0;
+            if (minPixels > 0.0f) {
+                __m256 size = _mm256_mul_ps(_mm256_loadu_ps(&b.radius[i]), sizeScale);
+                __m256 small = _mm256_cmp_ps(size, _mm256_mul_ps(minSize, nearDistance), _CMP_LT_OQ);
+                smallMask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_and_ps(inside, small)));
+            }
+            stats.outside += std::popcount(~insideMask & 0xFFu);
+            stats.small += std::popcount(smallMask);
+            visible.setRange(i, insideMask & ~smallMask, WIDTH);
+        }
+        return i;
+    }
+#elif defined(CULL_SSE)
+    static const size_t WIDTH = 4;
+
+    size_t vector(const BoundsSoA& b, size_t first, size_t end, CullStats& stats, VisibilityBits& visible) const {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 sizeScale = _mm_set1_ps(radiusScale);
+        const __m128 minSize = _mm_set1_ps(minPixels);
+        size_t i = first;
+        for (; i + WIDTH <= end; i += WIDTH) {
+            __m128 cx = _mm_loadu_ps(&b.centerX[i]), cy = _mm_loadu_ps(&b.centerY[i]), cz = _mm_loadu_ps(&b.centerZ[i]);
+            __m128 ex = _mm_loadu_ps(&b.extentX[i]), ey = _mm_loadu_ps(&b.extentY[i]), ez = _mm_loadu_ps(&b.extentZ[i]);
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            __m128 nearDistance = zero;
+            for (int p = 0; p < CullView::PlaneCount; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(nx[p]), cx), _mm_mul_ps(_mm_set1_ps(ny[p]), cy)),
+                                      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(nz[p]), cz), _mm_set1_ps(nw[p])));
+                __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ax[p]), ex), _mm_mul_ps(_mm_set1_ps(ay[p]), ey)),
+                                      _mm_mul_ps(_mm_set1_ps(az[p]), ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+                if (p == CullView::Near)
+                    nearDistance = d;
+            }
+            unsigned insideMask = static_cast<unsigned>(_mm_movemask_ps(inside));
+            unsigned smallMask = 0;
+            if (minPixels > 0.0f) {
+                __m128 size = _mm_mul_ps(_mm_loadu_ps(&b.radius[i]), sizeScale);
+                __m128 small = _mm_cmplt_ps(size, _mm_mul_ps(minSize, nearDistance));
+                smallMask = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(inside, small)));
+            }
+            stats.outside += std::popcount(~insideMask & 0xFu);
+            stats.small += std::popcount(smallMask);
+            visible.setRange(i, insideMask & ~smallMask, WIDTH);
+        }
+        return i;
+    }
+#else
+    size_t vector(const BoundsSoA&, size_t first, size_t, CullStats&, VisibilityBits&) const {
+        return first;
+    }
+#endif
+};
+
+CullStats cullBounds(const BoundsSoA& bounds, size_t first, size_t count, const CullView& view, VisibilityBits& visible) {
+    CullStats stats;
+    stats.tested = count;
+    stats.boxTests = count;
+
+    CullKernel kernel(view);
+    size_t end = first + count;
+    size_t done = kernel.vector(bounds, first, end, stats, visible);
+    kernel.scalar(bounds, done, end, stats, visible);
+    return stats;
+}
+
+const char* cullingBackend() {
+#if defined(CULL_AVX)
+    return "AVX";
+#elif defined(CULL_SSE)
+    return "SSE";
+#else
+    return "escalar";
+#endif
+}
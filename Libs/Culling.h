@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Caja alineada a los ejes, en el espacio del modelo (o del nodo dinámico de la malla)
+struct MeshBounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    float radius() const { return glm::length(max - min) * 0.5f; }
+    float surfaceArea() const;
+    void merge(const MeshBounds& other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+    // La caja alineada que envuelve a esta después de transformarla
+    MeshBounds transformed(const glm::mat4& matrix) const;
+};
+
+// Cámara vista desde el culling: los seis planos del frustum (normalizados, el
+// adentro es positivo) y la escala para estimar cuántos píxeles ocupa un objeto
+struct CullView {
+    enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+    glm::vec4 planes[PlaneCount];
+    float pixelScale = 0.0f;    // píxeles que ocupa 1 unidad a 1 unidad del plano near
+    float minPixels = 0.0f;     // diámetro proyectado mínimo; 0 = sin culling por tamaño
+    float objectScale = 1.0f;   // unidades del mundo por unidad del espacio de los planos
+
+    // Planos de projection * view (Gribb-Hartmann); viewportHeight en píxeles
+    static CullView make(const glm::mat4& projection, const glm::mat4& view, float viewportHeight, float minPixels);
+
+    // Los mismos planos en el espacio del objeto de model. Las distancias siguen
+    // saliendo en unidades del mundo, así que las cajas no hace falta transformarlas.
+    CullView toObject(const glm::mat4& model) const;
+
+    // Distancia (en unidades del mundo) del punto de la caja más cercano al
+    // plano near; negativa si la caja lo cruza
+    float nearDistance(const MeshBounds& box) const;
+
+    // La caja toca el frustum (prueba de los seis planos, una caja por vez)
+    bool intersects(const MeshBounds& box) const;
+};
+
+// Bits de visibilidad, uno por elemento
+class VisibilityBits {
+public:
+    void resize(size_t count, bool value);
+    size_t size() const { return bitCount; }
+
+    bool test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+    void set(size_t i, bool value);
+    // Los count bits de mask (el 0 primero) desde first
+    void setRange(size_t first, uint32_t mask, unsigned count);
+
+    size_t count() const;
+
+private:
+    std::vector<uint64_t> words;
+    size_t bitCount = 0;
+};
+
+// Cajas y esferas en estructura de arreglos, para probar de a 4 u 8 con SIMD
+class BoundsSoA {
+public:
+    void clear();
+    void reserve(size_t count);
+    void add(const glm::vec3& min, const glm::vec3& max);
+    size_t size() const { return centerX.size(); }
+
+private:
+    friend struct CullKernel;
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;   // medio lado
+    std::vector<float> radius;                      // esfera que envuelve la caja
+};
+
+// Resultado de un culling
+struct CullStats {
+    size_t tested = 0;
+    size_t outside = 0;   // fuera del frustum
+    size_t small = 0;     // adentro, pero más chicos que CullView::minPixels
+    size_t occluded = 0;  // adentro, pero tapados (ver OcclusionCuller)
+    size_t softwareOccluded = 0;  // adentro, pero tapados según SoftwareOcclusion
+    size_t boxTests = 0;  // cajas probadas contra los planos (nodos de Bvh incluidos)
+
+    size_t visible() const { return tested - outside - small - occluded - softwareOccluded; }
+    CullStats& operator+=(const CullStats& other);
+};
+
+// Prueba bounds[first, first + count) contra view y escribe un bit por elemento
+// en visible (en la misma posición, que ya debe existir). view debe estar en el
+// espacio de las cajas.
+CullStats cullBounds(const BoundsSoA& bounds, size_t first, size_t count, const CullView& view, VisibilityBits& visible);
+
+// Con qué instrucciones se compiló cullBounds: "AVX", "SSE" o "escalar"
+const char* cullingBackend();
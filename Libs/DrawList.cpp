@@ -0,0 +1,243 @@
+#include "DrawList.h"
+
+#include <algorithm>
+
+namespace {
+    // Dos mallas van al mismo lote si ligan los mismos arreglos en las mismas unidades
+    bool sameTextures(const Mesh& a, const Mesh& b) {
+        if (a.textures.size() != b.textures.size())
+            return false;
+        for (size_t i = 0; i < a.textures.size(); i++) {
+            if (a.textures[i].array != b.textures[i].array || a.textures[i].type != b.textures[i].type)
+                return false;
+        }
+        return true;
+    }
+
+    bool textureOrder(const Mesh& a, const Mesh& b) {
+        if (a.textures.size() != b.textures.size())
+            return a.textures.size() < b.textures.size();
+        for (size_t i = 0; i < a.textures.size(); i++) {
+            if (a.textures[i].array != b.textures[i].array)
+                return a.textures[i].array < b.textures[i].array;
+            if (a.textures[i].type != b.textures[i].type)
+                return a.textures[i].type < b.textures[i].type;
+        }
+        return false;
+    }
+}
+
+bool DrawList::indirectSupported() {
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
+void DrawList::clear() {
+    commands.clear();
+    commandSources.clear();
+    drawData.clear();
+    batches.clear();
+    groups.clear();
+    uploaded = false;
+}
+
+void DrawList::build(const std::vector<Mesh>& meshes, const std::vector<bool>& visible, uint32_t object) {
+    clear();
+    source = &meshes;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (meshes[i].node < 0 && (i >= visible.size() || visible[i]))
+            order.push_back(i);
+    }
+
+    // Agrupar por variante de shader, tipo de índice y texturas; dentro del lote, el orden original
+    std::stable_sort(order.begin(), order.end(), [&meshes](size_t a, size_t b) {
+        const Mesh& ma = meshes[a];
+        const Mesh& mb = meshes[b];
+        if (ma.features != mb.features)
+            return ma.features < mb.features;
+        if (ma.geometry.indexType != mb.geometry.indexType)
+            return ma.geometry.indexType < mb.geometry.indexType;
+        return textureOrder(ma, mb);
+    });
+
+    for (size_t i : order) {
+        const Mesh& mesh = meshes[i];
+        if (groups.empty() || groups.back().features != mesh.features)
+            groups.push_back(Group{ mesh.features, batches.size(), 0, 0 });
+        if (groups.back().batchCount == 0 || batches.back().indexType != mesh.geometry.indexType ||
+            !sameTextures(meshes[batches.back().mesh], mesh)) {
+            batches.push_back(Batch{ mesh.geometry.indexType, i, commands.size(), 0, 0 });
+            groups.back().batchCount++;
+        }
+        batches.back().visibleCount++;
+        groups.back().visibleCount++;
+
+        // Empieza en el nivel 0; cull elige el del frame
+        DrawElementsIndirectCommand command;
+        command.count = mesh.lods.front().indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = mesh.geometry.firstIndex + mesh.lods.front().firstIndex;
+        command.baseVertex = mesh.geometry.baseVertex;
+
+        DrawData data;
+        for (int k = 0; k < 3; k++) {
+            data.scale[k] = mesh.quantization.scale[k];
+            data.offset[k] = mesh.quantization.offset[k];
+        }
+        glm::vec4 layers = mesh.layers();
+        for (int k = 0; k < 4; k++)
+            data.layers[k] = layers[k];
+        data.object = static_cast<float>(object);
+        data.fade = 0.0f;
+
+        bool outgoing = false;
+        do {
+            command.baseInstance = static_cast<GLuint>(drawData.size());
+            commands.push_back(command);
+            commandSources.push_back(CommandSource{ static_cast<uint32_t>(i), outgoing });
+            drawData.push_back(data);
+            batches.back().commandCount++;
+            command.instanceCount = 0;
+            outgoing = !outgoing;
+        } while (outgoing && mesh.lods.size() > 1);
+    }
+}
+
+void DrawList::cull(const VisibilityBits* visible, const LodSelector* lods) {
+    for (Group& group : groups) {
+        group.visibleCount = 0;
+        for (size_t b = group.firstBatch; b < group.firstBatch + group.batchCount; b++) {
+            Batch& batch = batches[b];
+            batch.visibleCount = 0;
+            for (size_t c = batch.firstCommand; c < batch.firstCommand + batch.commandCount; c++) {
+                const CommandSource& from = commandSources[c];
+                const Mesh& mesh = (*source)[from.mesh];
+                bool shown = !visible || visible->test(from.mesh);
+                size_t level = 0;
+                float fade = 0.0f;
+                if (lods) {
+                    shown = shown && (!from.outgoing || lods->fading(from.mesh));
+                    level = from.outgoing ? lods->previous(from.mesh) : lods->level(from.mesh);
+                    fade = lods->fade(from.mesh, from.outgoing);
+                } else {
+                    shown = shown && !from.outgoing;
+                }
+
+                DrawElementsIndirectCommand& command = commands[c];
+                const MeshLod& lod = mesh.lods[level];
+                GLuint instances = shown ? 1 : 0;
+                GLuint firstIndex = mesh.geometry.firstIndex + lod.firstIndex;
+                if (command.instanceCount != instances || command.count != lod.indexCount || command.firstIndex != firstIndex) {
+                    command.instanceCount = instances;
+                    command.count = lod.indexCount;
+                    command.firstIndex = firstIndex;
+                    commandsDirty = true;
+                }
+                if (drawData[c].fade != fade) {
+                    drawData[c].fade = fade;
+                    drawDataDirty = true;
+                }
+                batch.visibleCount += instances;
+            }
+            group.visibleCount += batch.visibleCount;
+        }
+    }
+}
+
+void DrawList::upload() {
+    if (commandBuffer == 0) {
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &drawDataBuffer);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, drawDataBuffer);
+    glBufferData(GL_ARRAY_BUFFER, drawData.size() * sizeof(DrawData), drawData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploaded = true;
+    commandsDirty = false;
+    drawDataDirty = false;
+}
+
+void DrawList::submit(GLuint shaderProgram, DrawPath path, RenderState& state, size_t group) {
+    if (group >= groups.size())
+        return;
+    const Group& drawGroup = groups[group];
+    auto firstBatch = batches.begin() + drawGroup.firstBatch;
+    auto lastBatch = firstBatch + drawGroup.batchCount;
+
+    if (path == DrawPath::MultiDrawIndirect && indirectSupported()) {
+        if (!uploaded) {
+            upload();
+        } else if (commandsDirty) {
+            // Solo cambian los instanceCount: los DrawData quedan como están
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            commandsDirty = false;
+        }
+        if (drawDataDirty) {
+            // Transiciones de nivel de detalle en curso
+            glBindBuffer(GL_ARRAY_BUFFER, drawDataBuffer);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, drawData.size() * sizeof(DrawData), drawData.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            drawDataDirty = false;
+        }
+
+        // DrawData de cada comando: divisor 1 + baseInstance
+        glBindBuffer(GL_ARRAY_BUFFER, drawDataBuffer);
+        const GLsizei stride = sizeof(DrawData);
+        glVertexAttribPointer(DrawAttrib::Scale, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(DrawData, scale)));
+        glVertexAttribPointer(DrawAttrib::Offset, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(DrawData, offset)));
+        glVertexAttribPointer(DrawAttrib::Layer, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(DrawData, layers)));
+        glVertexAttribPointer(DrawAttrib::Object, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(DrawData, object)));
+        glVertexAttribPointer(DrawAttrib::Fade, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(DrawData, fade)));
+        for (GLuint location : { DrawAttrib::Scale, DrawAttrib::Offset, DrawAttrib::Layer, DrawAttrib::Object, DrawAttrib::Fade }) {
+            glVertexAttribDivisor(location, 1);
+            glEnableVertexAttribArray(location);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        for (auto batch = firstBatch; batch != lastBatch; ++batch) {
+            if (batch->visibleCount == 0)
+                continue;
+            (*source)[batch->mesh].bindTextures(shaderProgram, state);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, batch->indexType,
+                                        reinterpret_cast<const void*>(batch->firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(batch->commandCount), 0);
+            state.countDraw();
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        // Volver a los valores constantes para Mesh::Draw
+        for (GLuint location : { DrawAttrib::Scale, DrawAttrib::Offset, DrawAttrib::Layer, DrawAttrib::Object, DrawAttrib::Fade })
+            glDisableVertexAttribArray(location);
+        return;
+    }
+
+    // GL 3.3: mismos comandos, uno por llamada
+    for (auto batch = firstBatch; batch != lastBatch; ++batch) {
+        if (batch->visibleCount == 0)
+            continue;
+        (*source)[batch->mesh].bindTextures(shaderProgram, state);
+        GLsizei indexSizeBytes = static_cast<GLsizei>(indexSize(batch->indexType));
+        for (size_t i = batch->firstCommand; i < batch->firstCommand + batch->commandCount; i++) {
+            const DrawElementsIndirectCommand& command = commands[i];
+            if (command.instanceCount == 0)
+                continue;
+            const DrawData& data = drawData[i];
+            glVertexAttrib3fv(DrawAttrib::Scale, data.scale);
+            glVertexAttrib3fv(DrawAttrib::Offset, data.offset);
+            glVertexAttrib4fv(DrawAttrib::Layer, data.layers);
+            glVertexAttrib1f(DrawAttrib::Object, data.object);
+            glVertexAttrib1f(DrawAttrib::Fade, data.fade);
+            glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.count), batch->indexType,
+                                     reinterpret_cast<const void*>(size_t(command.firstIndex) * indexSizeBytes), command.baseVertex);
+        }
+        state.countDraw(batch->visibleCount);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad.h>
+#include "Culling.h"
+#include "LodSelector.h"
+#include "Mesh.h"
+
+#include <cstddef>
+#include <vector>
+
+// Cómo se envían las mallas estáticas (para comparar el costo de CPU)
+enum class DrawPath {
+    MeshLoop,            // Mesh::Draw por malla, como siempre
+    CachedLoop,          // la lista guardada, un glDrawElementsBaseVertex por comando (GL 3.3)
+    MultiDrawIndirect    // la lista guardada, un glMultiDrawElementsIndirect por lote (GL 4.3)
+};
+
+// Mismo layout que espera GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;  // 0 = malla descartada por el culling en este frame
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;   // índice del DrawData de este comando
+};
+
+// Atributos por dibujo (ver DrawAttrib), uno por comando
+struct DrawData {
+    float scale[3];
+    float offset[3];
+    float layers[4];
+    float object;   // ranura en ObjectBuffer
+    float fade;     // ver LodSelector::fade
+};
+
+// Lista de dibujos guardada para mallas que no cambian: comandos agrupados en
+// lotes que comparten variante de shader, texturas y tipo de índice. Solo se rehace con build()
+// cuando cambian las mallas visibles o sus materiales. Las mallas con varios
+// niveles de detalle llevan un segundo comando para el nivel que sale en una
+// transición (apagado el resto del tiempo).
+class DrawList {
+public:
+    // glMultiDrawElementsIndirect y baseInstance en atributos (GL 4.3)
+    static bool indirectSupported();
+
+    // visible[i] = false omite meshes[i]; solo se toman las mallas sin nodo dinámico,
+    // que se dibujan con la transformación de la ranura object
+    void build(const std::vector<Mesh>& meshes, const std::vector<bool>& visible, uint32_t object);
+    void clear();
+
+    // Visibilidad del frame, un bit por malla (nullptr = todas): los comandos de
+    // las mallas descartadas quedan con instanceCount = 0 sin rehacer la lista.
+    // lods: nivel de detalle de cada malla (nullptr = el 0)
+    void cull(const VisibilityBits* visible, const LodSelector* lods);
+
+    // Dibuja un grupo con el programa de su variante y el VAO de la arena ya ligados
+    void submit(GLuint shaderProgram, DrawPath path, RenderState& state, size_t group);
+
+    // Un grupo por variante de shader (Mesh::features); cada uno es un paquete de la cola
+    size_t groupCount() const { return groups.size(); }
+    uint32_t groupFeatures(size_t group) const { return groups[group].features; }
+    size_t groupVisibleCount(size_t group) const { return groups[group].visibleCount; }
+
+    size_t drawCount() const { return commands.size(); }
+    size_t batchCount() const { return batches.size(); }
+
+private:
+    struct Batch {
+        GLenum indexType;
+        size_t mesh;           // primera malla del lote: de ahí salen las texturas
+        size_t firstCommand;
+        size_t commandCount;
+        size_t visibleCount;
+    };
+
+    struct Group {
+        uint32_t features;
+        size_t firstBatch;
+        size_t batchCount;
+        size_t visibleCount;
+    };
+
+    // Malla de cada comando y si dibuja el nivel que sale
+    struct CommandSource {
+        uint32_t mesh;
+        bool outgoing;
+    };
+
+    void upload();
+
+    const std::vector<Mesh>* source = nullptr;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<CommandSource> commandSources;
+    std::vector<DrawData> drawData;
+    std::vector<Batch> batches;
+    std::vector<Group> groups;
+
+    GLuint commandBuffer = 0;
+    GLuint drawDataBuffer = 0;
+    bool uploaded = false;
+    bool commandsDirty = false;   // cambió algún comando desde la última subida
+    bool drawDataDirty = false;   // cambió algún fade
+};
@@ -0,0 +1,21 @@
+#include "FrameUniforms.h"
+#include "Shader.h"
+
+void FrameUniforms::attach(const Shader& shader) {
+    if (!shader.bindBlock("Frame", BINDING))
+        std::cerr << "El programa " << shader.Program << " no declara el bloque Frame" << std::endl;
+}
+
+void FrameUniforms::update(const FrameUniformData& data) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), nullptr, GL_DYNAMIC_DRAW);
+    }
+    // Se vuelve a ligar siempre: otro búfer puede haber ocupado el punto de
+    // enlace (el horneado de ImpostorAtlas usa uno propio)
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniformData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+
+class Shader;
+
+// Contenido del bloque "Frame" (std140) que declaran model.vert, model.frag y
+// skybox.vert. Mismo orden y relleno que en GLSL: vec3 ocupa 16 bytes.
+struct FrameUniformData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 skyboxView;      // view sin traslación
+    glm::vec4 viewPos;         // xyz; w sin usar
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+};
+static_assert(sizeof(FrameUniformData) == 3 * 64 + 3 * 16, "FrameUniformData no coincide con el layout std140");
+
+// Un uniform buffer con los datos de cámara y luz, escrito una vez por frame y
+// compartido por todos los programas que declaran el bloque "Frame".
+// Sin destructor: el búfer vive hasta que se destruye el contexto.
+class FrameUniforms {
+public:
+    static const GLuint BINDING = 0;
+
+    FrameUniforms() = default;
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Conecta el bloque "Frame" del programa al punto de enlace (una vez, al crearlo)
+    static void attach(const Shader& shader);
+
+    void update(const FrameUniformData& data);
+
+private:
+    GLuint buffer = 0;
+};
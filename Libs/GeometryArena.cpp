@@ -0,0 +1,177 @@
+#include "GeometryArena.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace {
+    // Tamaños mínimos al crecer sin reserve previo
+    const size_t MIN_VERTEX_CAPACITY = 64 * 1024;
+    const size_t MIN_INDEX_BYTES = 256 * 1024;
+
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Nuevo búfer de newBytes con el contenido de old (que se borra)
+    GLuint resizeBuffer(GLuint old, size_t oldBytes, size_t newBytes) {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_STATIC_DRAW);
+        if (old != 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, old);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glDeleteBuffers(1, &old);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+}
+
+bool RangeAllocator::allocate(size_t size, size_t& offset) {
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+        if (it->second < size)
+            continue;
+        offset = it->first;
+        size_t remaining = it->second - size;
+        freeBlocks.erase(it);
+        if (remaining > 0)
+            freeBlocks[offset + size] = remaining;
+        available -= size;
+        return true;
+    }
+    return false;
+}
+
+void RangeAllocator::release(size_t offset, size_t size) {
+    if (size == 0)
+        return;
+    available += size;
+
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+    if (next != freeBlocks.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += size;
+            return;
+        }
+    }
+    freeBlocks[offset] = size;
+}
+
+void RangeAllocator::grow(size_t newCapacity) {
+    if (newCapacity <= total)
+        return;
+    size_t added = newCapacity - total;
+    size_t offset = total;
+    total = newCapacity;
+    release(offset, added);
+}
+
+const void* GeometryRange::indexOffset() const {
+    return reinterpret_cast<const void*>(size_t(firstIndex) * indexSize(indexType));
+}
+
+GeometryArena& GeometryArena::instance(VertexFormat format) {
+    // Sin destructor: los búferes viven hasta que se destruye el contexto
+    static std::map<VertexFormat, std::unique_ptr<GeometryArena>> arenas;
+    auto& arena = arenas[format];
+    if (!arena)
+        arena.reset(new GeometryArena(format));
+    return *arena;
+}
+
+GeometryArena::GeometryArena(VertexFormat format)
+    : format(format), stride(vertexStride(format))
+{
+    glGenVertexArrays(1, &VAO);
+}
+
+void GeometryArena::growVertices(size_t minCapacity) {
+    size_t capacity = std::max({ minCapacity, vertexSpace.capacity() * 2, MIN_VERTEX_CAPACITY });
+    VBO = resizeBuffer(VBO, vertexSpace.capacity() * stride, capacity * stride);
+    vertexSpace.grow(capacity);
+
+    // Los punteros de atributos del VAO apuntan al VBO ligado al declararlos
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    withVertexLayout(format, [](auto layout) { decltype(layout)::setupAttributes(); });
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::growIndices(size_t minBytes) {
+    size_t capacity = alignUp(std::max({ minBytes, indexSpace.capacity() * 2, MIN_INDEX_BYTES }), 4);
+    EBO = resizeBuffer(EBO, indexSpace.capacity(), capacity);
+    indexSpace.grow(capacity);
+
+    // El EBO es parte del estado del VAO
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindVertexArray(0);
+}
+
+void GeometryArena::reserve(size_t vertexCount, size_t indexBytes) {
+    size_t freeVertices = vertexSpace.capacity() - vertexSpace.used();
+    if (freeVertices < vertexCount)
+        growVertices(vertexSpace.capacity() + vertexCount - freeVertices);
+
+    size_t freeIndexBytes = indexSpace.capacity() - indexSpace.used();
+    if (freeIndexBytes < indexBytes)
+        growIndices(indexSpace.capacity() + indexBytes - freeIndexBytes);
+}
+
+GeometryRange GeometryArena::allocate(const unsigned char* vertices, size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType) {
+    size_t indexBytes = indexCount * indexSize(indexType);
+    size_t indexBlock = alignUp(indexBytes, 4);
+
+    // El espacio libre puede estar fragmentado: crecer hasta que entre en un solo bloque
+    size_t vertexOffset = 0;
+    while (!vertexSpace.allocate(vertexCount, vertexOffset))
+        growVertices(vertexSpace.capacity() + vertexCount);
+    size_t indexOffset = 0;
+    while (!indexSpace.allocate(indexBlock, indexOffset))
+        growIndices(indexSpace.capacity() + indexBlock);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * stride, vertexCount * stride, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Por GL_COPY_WRITE_BUFFER para no tocar el EBO del VAO que esté ligado
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes, indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    GeometryRange range;
+    range.baseVertex = static_cast<GLint>(vertexOffset);
+    range.firstIndex = static_cast<GLuint>(indexOffset / indexSize(indexType));
+    range.count = static_cast<GLsizei>(indexCount);
+    range.indexType = indexType;
+    range.vertexCount = vertexCount;
+    return range;
+}
+
+void GeometryArena::release(const GeometryRange& range) {
+    vertexSpace.release(static_cast<size_t>(range.baseVertex), range.vertexCount);
+    size_t indexBytes = size_t(range.count) * indexSize(range.indexType);
+    indexSpace.release(size_t(range.firstIndex) * indexSize(range.indexType), alignUp(indexBytes, 4));
+}
+
+void GeometryArena::bind() const {
+    glBindVertexArray(VAO);
+}
+
+size_t GeometryArena::usedBytes() const {
+    return vertexSpace.used() * stride + indexSpace.used();
+}
+
+size_t GeometryArena::capacityBytes() const {
+    return vertexSpace.capacity() * stride + indexSpace.capacity();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad.h>
+#include "VertexLayout.h"
+
+#include <cstddef>
+#include <map>
+
+// Espacio libre de un búfer, en unidades arbitrarias (vértices o bytes).
+// Primer ajuste; los bloques liberados se fusionan con sus vecinos.
+class RangeAllocator {
+public:
+    // false si no hay un bloque libre de size unidades
+    bool allocate(size_t size, size_t& offset);
+    void release(size_t offset, size_t size);
+
+    // Agrega [capacity, newCapacity) al espacio libre
+    void grow(size_t newCapacity);
+
+    size_t capacity() const { return total; }
+    size_t used() const { return total - available; }
+
+private:
+    std::map<size_t, size_t> freeBlocks;   // offset -> tamaño
+    size_t total = 0;
+    size_t available = 0;
+};
+
+// Ubicación de una malla dentro de su GeometryArena
+struct GeometryRange {
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;     // en unidades de indexType
+    GLsizei count = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    size_t vertexCount = 0;
+
+    // Desplazamiento en bytes dentro del EBO, para glDrawElementsBaseVertex
+    const void* indexOffset() const;
+};
+
+// Un VBO, un EBO y un VAO compartidos por todas las mallas estáticas de un
+// VertexFormat. Cada malla ocupa un rango y se dibuja con glDrawElementsBaseVertex,
+// así un modelo entero liga un solo VAO. Los búferes crecen copiando en la GPU.
+// Solo desde el hilo de OpenGL.
+class GeometryArena {
+public:
+    static GeometryArena& instance(VertexFormat format);
+
+    // Asegura espacio libre para tanto contenido (evita copias al crecer de a poco)
+    void reserve(size_t vertexCount, size_t indexBytes);
+
+    // Copia los vértices (ya empaquetados en el formato de la arena) y los índices
+    GeometryRange allocate(const unsigned char* vertices, size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType);
+    void release(const GeometryRange& range);
+
+    // Liga el VAO compartido
+    void bind() const;
+    GLuint vertexArray() const { return VAO; }
+
+    size_t usedBytes() const;
+    size_t capacityBytes() const;
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+private:
+    explicit GeometryArena(VertexFormat format);
+
+    void growVertices(size_t minCapacity);
+    void growIndices(size_t minBytes);
+
+    VertexFormat format;
+    size_t stride;
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    RangeAllocator vertexSpace;   // en vértices
+    RangeAllocator indexSpace;    // en bytes, de a 4 para que ambos tipos de índice queden alineados
+};
@@ -0,0 +1,391 @@
+#include "ImpostorAtlas.h"
+#include "BakedTexture.h"
+#include "FrameUniforms.h"
+#include "LoadProfiler.h"
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "ObjectBuffer.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <gtc/matrix_transform.hpp>
+
+namespace {
+    const char MAGIC[4] = { 'S', 'T', 'I', 'M' };
+
+    struct ImpostorHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t frames;
+        uint32_t frameSize;
+        uint32_t layerCount;
+        uint32_t reserved;
+        uint64_t meshCacheSize;
+        int64_t meshCacheTime;
+        uint64_t textureKey;
+    };
+
+    bool fileStamp(const std::string& path, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec)
+            return false;
+        time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    // FNV-1a sobre la ruta, el tamaño y la fecha de cada textura de los
+    // clusters y de su .sttex (0 si no existe): cambia si se edita o se vuelve
+    // a hornear cualquiera de las imágenes que leyó el horneado
+    uint64_t textureKey(const std::string& sourcePath, const std::vector<Mesh>& meshes, const std::vector<ImpostorCluster>& clusters) {
+        std::string directory = sourcePath.substr(0, sourcePath.find_last_of('/'));
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix = [&h](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                h ^= bytes[i];
+                h *= 0x100000001B3ull;
+            }
+        };
+        for (const ImpostorCluster& cluster : clusters) {
+            for (uint32_t m : cluster.meshes) {
+                for (const Texture& texture : meshes[m].textures) {
+                    std::string path = directory + "/" + texture.path;
+                    for (const std::string& file : { path, BakedTexture::bakedPath(path) }) {
+                        uint64_t size = 0;
+                        int64_t time = 0;
+                        if (!fileStamp(file, size, time))
+                            size = time = 0;
+                        mix(file.data(), file.size());
+                        mix(&size, sizeof(size));
+                        mix(&time, sizeof(time));
+                    }
+                }
+            }
+        }
+        return h;
+    }
+
+    // Programas compartidos por todos los atlas.
+    // Sin destructor: viven hasta que se destruye el contexto
+    struct ImpostorPrograms {
+        std::unique_ptr<Shader> bake;     // model.vert + impostor_bake.frag
+        std::unique_ptr<Shader> draw;     // impostor.vert + impostor.frag
+        FrameUniforms bakeFrame;          // la cámara de cada vista del horneado
+        GLint objectLocation = -1, upLocation = -1, tangentLocation = -1;
+    };
+
+    ImpostorPrograms& programs() {
+        static ImpostorPrograms* shared = new ImpostorPrograms();
+        if (!shared->draw) {
+            shared->bake.reset(new Shader("Shaders/model.vert", "Shaders/impostor_bake.frag"));
+            FrameUniforms::attach(*shared->bake);
+            shared->bake->Use();
+            shared->bake->setInt("objects", static_cast<int>(ObjectBuffer::TEXTURE_UNIT));
+
+            shared->draw.reset(new Shader("Shaders/impostor.vert", "Shaders/impostor.frag"));
+            FrameUniforms::attach(*shared->draw);
+            shared->draw->Use();
+            shared->draw->setInt("objects", static_cast<int>(ObjectBuffer::TEXTURE_UNIT));
+            shared->draw->setInt("impostorAlbedo", 0);
+            shared->draw->setInt("impostorNormalDepth", 1);
+            shared->objectLocation = shared->draw->location("object");
+            shared->upLocation = shared->draw->location("impostorUp");
+            shared->tangentLocation = shared->draw->location("impostorTangent");
+            glUseProgram(0);
+        }
+        return *shared;
+    }
+
+    // Dirección de la vista (column, row): la inversa de la codificación
+    // hemi-octaédrica de impostor.vert, en la base tangent, up, bitangent
+    glm::vec3 frameDirection(int column, int row, const glm::vec3& tangent, const glm::vec3& up, const glm::vec3& bitangent) {
+        float last = static_cast<float>(ImpostorAtlas::FRAMES - 1);
+        glm::vec2 uv = glm::vec2(column, row) / last * 2.0f - 1.0f;
+        float x = (uv.x + uv.y) * 0.5f;
+        float z = (uv.x - uv.y) * 0.5f;
+        float y = 1.0f - std::abs(x) - std::abs(z);
+        return glm::normalize(tangent * x + up * y + bitangent * z);
+    }
+}
+
+ImpostorStats& ImpostorStats::operator+=(const ImpostorStats& other) {
+    clusters += other.clusters;
+    drawn += other.drawn;
+    triangles += other.triangles;
+    return *this;
+}
+
+ImpostorAtlas::~ImpostorAtlas() {
+    release();
+}
+
+std::string ImpostorAtlas::cachePath(const std::string& sourcePath) {
+    return sourcePath + ".stimp";
+}
+
+void ImpostorAtlas::release() {
+    if (albedo != 0)
+        glDeleteTextures(1, &albedo);
+    if (normalDepth != 0)
+        glDeleteTextures(1, &normalDepth);
+    if (instanceBuffer != 0)
+        glDeleteBuffers(1, &instanceBuffer);
+    if (instanceArray != 0)
+        glDeleteVertexArrays(1, &instanceArray);
+    albedo = normalDepth = instanceBuffer = instanceArray = 0;
+    layerCount = 0;
+    instances.clear();
+}
+
+void ImpostorAtlas::build(const std::string& sourcePath, std::vector<Mesh>& meshes, const std::vector<ImpostorCluster>& clusters,
+                          uint32_t object, GLuint vertexArray, const glm::vec3& upDirection) {
+    ScopedTimer timer("Impostores", sourcePath);
+    release();
+    if (clusters.empty() || meshes.empty())
+        return;
+
+    // Base del hemisferio: la vertical y dos ejes cualesquiera del suelo
+    up = glm::normalize(upDirection);
+    glm::vec3 helper = std::abs(up.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    tangent = glm::normalize(glm::cross(helper, up));
+    bitangent = glm::cross(tangent, up);
+
+    size_t layers = clusters.size();
+    uint64_t textures = textureKey(sourcePath, meshes, clusters);
+    bool cached = load(sourcePath, layers, textures);
+    if (!cached) {
+        createTextures(layers);
+        bake(meshes, clusters, object, vertexArray);
+        if (!save(sourcePath, layers, textures))
+            std::cerr << "ImpostorAtlas: no se pudo escribir " << cachePath(sourcePath) << std::endl;
+    }
+    layerCount = layers;
+
+    // Una instancia por cluster dibujado: esfera y capa, avanzando de a una por instancia
+    glGenVertexArrays(1, &instanceArray);
+    glGenBuffers(1, &instanceBuffer);
+    glBindVertexArray(instanceArray);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, layers * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offsetof(Instance, sphere)));
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offsetof(Instance, layer)));
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    materialId = RenderQueue::materialId({ instanceArray, albedo, normalDepth });
+
+    size_t bytes = size_t(ATLAS_SIZE) * ATLAS_SIZE * 4 * layers * 2;
+    std::cout << "ImpostorAtlas: " << cachePath(sourcePath) << ": " << layers << " clusters de " << FRAMES * FRAMES
+              << " vistas, " << (cached ? "leídos de la caché" : "horneados") << ", ~"
+              << bytes * 4 / 3 / (1024 * 1024) << " MB de VRAM" << std::endl;
+}
+
+void ImpostorAtlas::createTextures(size_t layers) {
+    for (GLuint* texture : { &albedo, &normalDepth }) {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, *texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, static_cast<GLsizei>(layers), 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        // Pocos niveles: más abajo las vistas vecinas se mezclan entre sí
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, MIP_LEVELS);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// Cada cluster en su capa: FRAMES x FRAMES vistas ortográficas que encierran
+// su esfera, desde 2 radios de distancia. Con el fondo en 0, los mipmaps
+// quedan premultiplicados por la cobertura en las dos texturas.
+void ImpostorAtlas::bake(std::vector<Mesh>& meshes, const std::vector<ImpostorCluster>& clusters, uint32_t object, GLuint vertexArray) {
+    ImpostorPrograms& shared = programs();
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    GLuint framebuffer = 0, depth = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, ATLAS_SIZE, ATLAS_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    // La ranura del modelo en identidad: posiciones y normales en su espacio
+    ObjectBuffer& objects = ObjectBuffer::instance();
+    objects.setModel(object, glm::mat4(1.0f));
+    objects.upload();
+
+    RenderStats stats;
+    RenderState state(stats);
+    Shader& shader = *shared.bake;
+    state.useProgram(shader.Program);
+    state.bindVertexArray(vertexArray);
+    shader.setInt("octNormals", meshes.front().octNormals ? 1 : 0);
+
+    const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (size_t layer = 0; layer < clusters.size(); layer++) {
+        const ImpostorCluster& cluster = clusters[layer];
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedo, 0, static_cast<GLint>(layer));
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, normalDepth, 0, static_cast<GLint>(layer));
+        if (layer == 0 && glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ImpostorAtlas: el framebuffer del horneado está incompleto" << std::endl;
+            break;
+        }
+        glClearBufferfv(GL_COLOR, 0, clearColor);
+        glClearBufferfv(GL_COLOR, 1, clearColor);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        glm::vec3 center = cluster.bounds.center();
+        float radius = std::max(cluster.bounds.radius(), 1e-3f);
+        for (int row = 0; row < FRAMES; row++) {
+            for (int column = 0; column < FRAMES; column++) {
+                glViewport(column * FRAME_SIZE, row * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+                // Los mismos ejes que rearma impostor.frag para leer la vista
+                glm::vec3 direction = frameDirection(column, row, tangent, up, bitangent);
+                glm::vec3 hint = std::abs(glm::dot(direction, up)) > 0.999f ? bitangent : up;
+                glm::vec3 eye = center + direction * (2.0f * radius);
+
+                FrameUniformData frame{};
+                frame.view = glm::lookAt(eye, center, hint);
+                frame.projection = glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius);
+                frame.viewPos = glm::vec4(eye, 1.0f);
+                shared.bakeFrame.update(frame);
+
+                for (uint32_t m : cluster.meshes)
+                    meshes[m].Draw(shader.Program, state, object, 0);
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteFramebuffers(1, &framebuffer);
+    glBindVertexArray(0);
+
+    for (GLuint texture : { albedo, normalDepth }) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+bool ImpostorAtlas::load(const std::string& sourcePath, size_t layers, uint64_t textures) {
+    uint64_t meshCacheSize = 0;
+    int64_t meshCacheTime = 0;
+    if (!fileStamp(MeshCache::cachePath(sourcePath), meshCacheSize, meshCacheTime))
+        return false;
+
+    std::ifstream in(cachePath(sourcePath), std::ios::binary);
+    ImpostorHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.frames != static_cast<uint32_t>(FRAMES) || header.frameSize != static_cast<uint32_t>(FRAME_SIZE) ||
+        header.layerCount != layers || header.meshCacheSize != meshCacheSize || header.meshCacheTime != meshCacheTime ||
+        header.textureKey != textures) {
+        std::cout << "ImpostorAtlas: " << cachePath(sourcePath) << " obsoleta, se vuelve a hornear" << std::endl;
+        return false;
+    }
+
+    // Solo el nivel 0 de cada textura, todas las capas seguidas
+    std::vector<unsigned char> pixels(size_t(ATLAS_SIZE) * ATLAS_SIZE * 4 * layers);
+    createTextures(layers);
+    for (GLuint texture : { albedo, normalDepth }) {
+        if (!in.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()))) {
+            release();
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, ATLAS_SIZE, ATLAS_SIZE, static_cast<GLsizei>(layers), GL_RGBA,
+                        GL_UNSIGNED_BYTE, pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+bool ImpostorAtlas::save(const std::string& sourcePath, size_t layers, uint64_t textures) const {
+    ImpostorHeader header{};
+    if (!fileStamp(MeshCache::cachePath(sourcePath), header.meshCacheSize, header.meshCacheTime))
+        return false;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.frames = FRAMES;
+    header.frameSize = FRAME_SIZE;
+    header.layerCount = static_cast<uint32_t>(layers);
+    header.textureKey = textures;
+
+    // Escribir a un temporal y renombrar, como MeshCache
+    std::string finalPath = cachePath(sourcePath);
+    std::string tempPath = finalPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<unsigned char> pixels(size_t(ATLAS_SIZE) * ATLAS_SIZE * 4 * layers);
+        for (GLuint texture : { albedo, normalDepth }) {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+            glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            out.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(finalPath, ec);
+    std::filesystem::rename(tempPath, finalPath, ec);
+    return !ec;
+}
+
+void ImpostorAtlas::add(const ImpostorCluster& cluster, size_t index) {
+    instances.push_back(Instance{ glm::vec4(cluster.bounds.center(), cluster.bounds.radius()), static_cast<float>(index) });
+}
+
+GLuint ImpostorAtlas::program() const {
+    return programs().draw->Program;
+}
+
+void ImpostorAtlas::draw(RenderState& state, uint32_t object) {
+    if (instances.empty())
+        return;
+    ImpostorPrograms& shared = programs();
+    state.setInt(shared.objectLocation, static_cast<GLint>(object));
+    glUniform3fv(shared.upLocation, 1, &up[0]);
+    glUniform3fv(shared.tangentLocation, 1, &tangent[0]);
+    state.bindTexture(0, GL_TEXTURE_2D_ARRAY, albedo);
+    state.bindTexture(1, GL_TEXTURE_2D_ARRAY, normalDepth);
+
+    // Se descarta el contenido anterior para no esperar al frame que lo usa
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, layerCount * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+    state.countDraw();
+}
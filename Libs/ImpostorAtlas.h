@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+#include "Culling.h"
+#include "RenderQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Mesh;
+
+// Mallas estáticas de una celda de ClusterGrid, que de lejos se reemplazan por un impostor
+struct ImpostorCluster {
+    MeshBounds bounds;
+    std::vector<uint32_t> meshes;   // índices en las mallas del modelo
+    size_t triangles = 0;           // del nivel 0
+};
+
+// Impostores dibujados en el último submit
+struct ImpostorStats {
+    size_t clusters = 0;    // con atlas
+    size_t drawn = 0;       // dibujados como impostor (en el frustum)
+    size_t triangles = 0;   // del nivel 0 de esos clusters, que no se dibujaron
+
+    ImpostorStats& operator+=(const ImpostorStats& other);
+};
+
+// Impostores octaédricos: cada cluster se hornea desde FRAMES x FRAMES vistas
+// del hemisferio de arriba (codificación hemi-octaédrica) en una capa de dos
+// arreglos de texturas: albedo con la cobertura en alfa, y la normal del
+// modelo con la profundidad en alfa. De lejos, el cluster se dibuja como un
+// cuadrado que mira a la cámara y mezcla las tres vistas más cercanas a la
+// dirección desde la que se lo mira (ver impostor.vert); la profundidad
+// guardada corrige la del cuadrado para que se cruce bien con lo demás.
+// Los atlas se guardan en scene.gltf.stimp y se vuelven a hornear si cambia
+// la caché de mallas (ver MeshCache) o alguna textura de los clusters.
+// Solo desde el hilo de OpenGL.
+class ImpostorAtlas {
+public:
+    static constexpr int FRAMES = 8;                         // vistas por lado
+    static constexpr int FRAME_SIZE = 32;                    // píxeles por vista
+    static constexpr int ATLAS_SIZE = FRAMES * FRAME_SIZE;
+    static constexpr int MIP_LEVELS = 2;                     // hasta 8 píxeles por vista
+    static const uint32_t VERSION = 2;
+
+    ImpostorAtlas() = default;
+    ~ImpostorAtlas();
+    ImpostorAtlas(const ImpostorAtlas&) = delete;
+    ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+    static std::string cachePath(const std::string& sourcePath);
+
+    // Lee los atlas de la caché o los hornea y los guarda. Para hornear dibuja
+    // las mallas de cada cluster con el VAO de su arena y la ranura object de
+    // ObjectBuffer, que deja en identidad. upDirection: la vertical del modelo (ClusterGrid::up)
+    void build(const std::string& sourcePath, std::vector<Mesh>& meshes, const std::vector<ImpostorCluster>& clusters,
+               uint32_t object, GLuint vertexArray, const glm::vec3& upDirection);
+
+    bool ready() const { return albedo != 0; }
+
+    // Por frame: los clusters que se dibujan como impostor
+    void clear() { instances.clear(); }
+    void add(const ImpostorCluster& cluster, size_t index);
+    size_t instanceCount() const { return instances.size(); }
+
+    GLuint program() const;
+    GLuint vertexArray() const { return instanceArray; }
+    uint32_t material() const { return materialId; }
+
+    // Con el programa y el VAO del paquete ya ligados; object: ranura del modelo
+    void draw(RenderState& state, uint32_t object);
+
+private:
+    struct Instance {
+        glm::vec4 sphere;   // centro y radio en el espacio del modelo
+        float layer;
+    };
+
+    void release();
+    void createTextures(size_t layers);
+    void bake(std::vector<Mesh>& meshes, const std::vector<ImpostorCluster>& clusters, uint32_t object, GLuint vertexArray);
+    // La caché vale mientras no cambien la de mallas (tamaño y fecha del .stmesh)
+    // ni las texturas: textures resume las de los clusters (ver textureKey)
+    bool load(const std::string& sourcePath, size_t layers, uint64_t textures);
+    bool save(const std::string& sourcePath, size_t layers, uint64_t textures) const;
+
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+    GLuint albedo = 0;        // GL_TEXTURE_2D_ARRAY RGBA8, una capa por cluster
+    GLuint normalDepth = 0;   // ídem
+    GLuint instanceArray = 0;
+    GLuint instanceBuffer = 0;        // capacidad: una instancia por capa
+    size_t layerCount = 0;
+    uint32_t materialId = 0;
+    std::vector<Instance> instances;
+};
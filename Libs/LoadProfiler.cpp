@@ -0,0 +1,214 @@
+#include "LoadProfiler.h"
+#include "imgui.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace {
+    struct CategoryTotal {
+        int count = 0;
+        double totalMs = 0.0;
+    };
+
+    // Cadena JSON con comillas; las rutas de Windows traen barras invertidas
+    std::string quoted(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out += ' ';
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+        return out;
+    }
+
+    std::map<std::string, CategoryTotal> totalsByCategory(const std::vector<ProfileSample>& samples) {
+        std::map<std::string, CategoryTotal> totals;
+        for (const auto& sample : samples) {
+            totals[sample.category].count++;
+            totals[sample.category].totalMs += sample.durationMs;
+        }
+        return totals;
+    }
+}
+
+LoadProfiler& LoadProfiler::instance() {
+    static LoadProfiler profiler;
+    return profiler;
+}
+
+void LoadProfiler::begin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    origin = Clock::now();
+    mainThread = std::this_thread::get_id();
+    threadIndex[mainThread] = 0;
+}
+
+double LoadProfiler::sinceBegin(Clock::time_point time) const {
+    return std::chrono::duration<double, std::milli>(time - origin).count();
+}
+
+void LoadProfiler::record(const std::string& category, const std::string& name, Clock::time_point start, Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ProfileSample sample;
+    sample.category = category;
+    sample.name = name;
+    sample.startMs = sinceBegin(start);
+    sample.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    auto it = threadIndex.find(std::this_thread::get_id());
+    if (it == threadIndex.end())
+        it = threadIndex.emplace(std::this_thread::get_id(), static_cast<int>(threadIndex.size())).first;
+    sample.thread = it->second;
+
+    samples.push_back(std::move(sample));
+}
+
+void LoadProfiler::markFirstInteractiveFrame() {
+    if (firstFrameMs < 0.0)
+        firstFrameMs = sinceBegin(Clock::now());
+}
+
+void LoadProfiler::markSceneReady() {
+    if (readyMs < 0.0)
+        readyMs = sinceBegin(Clock::now());
+}
+
+bool LoadProfiler::writeJson(const std::string& path) {
+    std::vector<ProfileSample> copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = samples;
+    }
+    std::sort(copy.begin(), copy.end(), [](const ProfileSample& a, const ProfileSample& b) {
+        return a.startMs < b.startMs;
+    });
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "LoadProfiler: no se pudo escribir " << path << std::endl;
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"firstInteractiveFrameMs\": " << firstFrameMs << ",\n";
+    file << "  \"sceneReadyMs\": " << readyMs << ",\n";
+
+    file << "  \"categories\": {";
+    bool first = true;
+    for (const auto& [category, total] : totalsByCategory(copy)) {
+        file << (first ? "\n" : ",\n") << "    " << quoted(category)
+             << ": { \"count\": " << total.count << ", \"totalMs\": " << total.totalMs << " }";
+        first = false;
+    }
+    file << "\n  },\n";
+
+    file << "  \"samples\": [";
+    first = true;
+    for (const auto& sample : copy) {
+        file << (first ? "\n" : ",\n") << "    { \"category\": " << quoted(sample.category)
+             << ", \"name\": " << quoted(sample.name)
+             << ", \"startMs\": " << sample.startMs
+             << ", \"durationMs\": " << sample.durationMs
+             << ", \"thread\": " << sample.thread << " }";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+
+    std::cout << "LoadProfiler: " << copy.size() << " mediciones escritas en " << path << std::endl;
+    return true;
+}
+
+void LoadProfiler::drawWindow(bool* open) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sorted.size() != samples.size()) {
+            sorted = samples;
+            std::sort(sorted.begin(), sorted.end(), [](const ProfileSample& a, const ProfileSample& b) {
+                return a.durationMs > b.durationMs;
+            });
+        }
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(560, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Perfil de carga", open)) {
+        ImGui::End();
+        return;
+    }
+
+    if (firstFrameMs >= 0.0)
+        ImGui::Text("Primer frame interactivo: %.1f ms", firstFrameMs);
+    else
+        ImGui::Text("Primer frame interactivo: -");
+    if (readyMs >= 0.0)
+        ImGui::Text("Escena lista: %.1f ms", readyMs);
+    else
+        ImGui::Text("Escena lista: cargando...");
+
+    // Totales por categoría (los hilos de trabajo se solapan: la suma puede superar el tiempo real)
+    if (ImGui::BeginTable("categorias", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Categoría");
+        ImGui::TableSetupColumn("Cantidad");
+        ImGui::TableSetupColumn("Total (ms)");
+        ImGui::TableHeadersRow();
+
+        auto totals = totalsByCategory(sorted);
+        std::vector<std::pair<std::string, CategoryTotal>> ordered(totals.begin(), totals.end());
+        std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+            return a.second.totalMs > b.second.totalMs;
+        });
+        for (const auto& [category, total] : ordered) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(category.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", total.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", total.totalMs);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Spacing();
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("mediciones", 5, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("Categoría", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("Recurso", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Inicio", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("Hilo", ImGuiTableColumnFlags_WidthFixed, 35.0f);
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(sorted.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const ProfileSample& sample = sorted[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", sample.durationMs);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(sample.category.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(sample.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f", sample.startMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", sample.thread);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Una medición de la carga (tiempos en ms desde LoadProfiler::begin)
+struct ProfileSample {
+    std::string category;   // "Inicio", "Shader", "Assimp", "Malla", "Textura", ...
+    std::string name;       // ruta o nombre del recurso
+    double startMs = 0.0;
+    double durationMs = 0.0;
+    int thread = 0;         // 0 = hilo principal, 1.. = hilos de trabajo
+};
+
+// Perfil del arranque: junta mediciones de cualquier hilo, escribe un informe
+// JSON y dibuja una tabla ImGui ordenada por costo.
+class LoadProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static LoadProfiler& instance();
+
+    // Marca el instante cero; llamar al principio de main desde el hilo principal
+    void begin();
+
+    void record(const std::string& category, const std::string& name, Clock::time_point start, Clock::time_point end);
+
+    // Primer frame presentado con el menú ya usable
+    void markFirstInteractiveFrame();
+    // Todos los recursos requeridos residentes
+    void markSceneReady();
+
+    double firstInteractiveFrameMs() const { return firstFrameMs; }
+    double sceneReadyMs() const { return readyMs; }
+
+    bool writeJson(const std::string& path);
+
+    // Ventana "Perfil de carga" (llamar entre ImGui::NewFrame y ImGui::Render)
+    void drawWindow(bool* open);
+
+    LoadProfiler(const LoadProfiler&) = delete;
+    LoadProfiler& operator=(const LoadProfiler&) = delete;
+
+private:
+    LoadProfiler() = default;
+
+    double sinceBegin(Clock::time_point time) const;
+
+    Clock::time_point origin = Clock::now();
+    std::thread::id mainThread;
+    double firstFrameMs = -1.0;
+    double readyMs = -1.0;
+
+    std::mutex mutex;
+    std::vector<ProfileSample> samples;
+    std::unordered_map<std::thread::id, int> threadIndex;
+
+    // Copia ordenada para la tabla; se rehace cuando llegan mediciones nuevas
+    std::vector<ProfileSample> sorted;
+};
+
+// Mide desde su construcción hasta stop() o hasta salir del ámbito
+class ScopedTimer {
+public:
+    ScopedTimer(const char* category, std::string name)
+        : category(category), name(std::move(name)), start(LoadProfiler::Clock::now()) {}
+
+    ~ScopedTimer() { stop(); }
+
+    void stop()
+    {
+        if (stopped)
+            return;
+        stopped = true;
+        LoadProfiler::instance().record(category, name, start, LoadProfiler::Clock::now());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* category;
+    std::string name;
+    LoadProfiler::Clock::time_point start;
+    bool stopped = false;
+};
@@ -0,0 +1,92 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Un frame largo (carga, ventana arrastrada) no termina las transiciones de golpe
+    const double MAX_FRAME_SECONDS = 0.1;
+    // El nivel que entra empieza sin cubrir ningún píxel (el menor umbral del tramado es 1/32)
+    const float MIN_FADE = 1.0f / 64.0f;
+}
+
+size_t LodStats::totalTriangles() const {
+    size_t total = 0;
+    for (size_t count : triangles)
+        total += count;
+    return total;
+}
+
+LodStats& LodStats::operator+=(const LodStats& other) {
+    for (size_t level = 0; level < MeshSimplifier::MAX_LODS; level++) {
+        meshes[level] += other.meshes[level];
+        triangles[level] += other.triangles[level];
+    }
+    fullTriangles += other.fullTriangles;
+    fading += other.fading;
+    return *this;
+}
+
+void LodSelector::resize(size_t count) {
+    states.resize(count);
+}
+
+void LodSelector::beginFrame(double now) {
+    double elapsed = lastTime < 0.0 ? 0.0 : std::min(now - lastTime, MAX_FRAME_SECONDS);
+    step = static_cast<float>(std::max(elapsed, 0.0) / FADE_SECONDS);
+    lastTime = now;
+}
+
+void LodSelector::update(size_t i, const std::vector<MeshLod>& lods, float pixelsPerUnit, float bias, bool crossfade) {
+    State& state = states[i];
+    if (state.progress < 1.0f) {
+        state.progress += step;
+        if (state.progress < 1.0f)
+            return;
+        state.progress = 1.0f;
+        state.previous = state.level;
+    }
+
+    uint32_t current = std::min<uint32_t>(state.level, static_cast<uint32_t>(lods.size()) - 1);
+    float threshold = PIXEL_ERROR * std::exp2(bias);
+    auto pixels = [&](uint32_t level) { return lods[level].error * pixelsPerUnit; };
+
+    // El más simple que entra en el umbral (los errores crecen con el nivel)
+    uint32_t target = 0;
+    for (uint32_t level = static_cast<uint32_t>(lods.size()) - 1; level > 0; level--) {
+        if (pixels(level) <= threshold) {
+            target = level;
+            break;
+        }
+    }
+
+    uint32_t next = current;
+    if (target > current) {
+        for (uint32_t level = target; level > current; level--) {
+            if (pixels(level) <= threshold * (1.0f - HYSTERESIS)) {
+                next = level;
+                break;
+            }
+        }
+    } else if (target < current && pixels(current) > threshold * (1.0f + HYSTERESIS)) {
+        next = target;
+    }
+
+    state.previous = crossfade && next != current ? static_cast<uint8_t>(current) : static_cast<uint8_t>(next);
+    state.level = static_cast<uint8_t>(next);
+    state.progress = state.previous != state.level ? 0.0f : 1.0f;
+}
+
+void LodSelector::skip(size_t i) {
+    State& state = states[i];
+    state.previous = state.level;
+    state.progress = 1.0f;
+}
+
+float LodSelector::fade(size_t i, bool outgoing) const {
+    const State& state = states[i];
+    if (state.level == state.previous)
+        return 0.0f;
+    float progress = std::clamp(state.progress, MIN_FADE, 1.0f - MIN_FADE);
+    return outgoing ? -progress : progress;
+}
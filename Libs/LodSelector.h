@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MeshSimplifier.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mallas y triángulos dibujados por nivel de detalle
+struct LodStats {
+    size_t meshes[MeshSimplifier::MAX_LODS] = {};
+    size_t triangles[MeshSimplifier::MAX_LODS] = {};   // incluye el nivel que sale en una transición
+    size_t fullTriangles = 0;   // los mismos dibujos, todos en el nivel 0
+    size_t fading = 0;          // mallas en transición (dibujan dos niveles)
+
+    size_t totalTriangles() const;
+    LodStats& operator+=(const LodStats& other);
+};
+
+// Nivel de detalle de cada malla de un modelo: el más simple cuyo error
+// (MeshLod::error) proyectado en pantalla no pasa de PIXEL_ERROR píxeles,
+// escalado por el sesgo. Cerca del umbral no salta de un nivel a otro: para
+// pasar a uno más simple tiene que quedar HYSTERESIS por debajo y para volver
+// a uno más detallado, pasarse HYSTERESIS por arriba. Con transición, el
+// nivel anterior se sigue dibujando FADE_SECONDS con un tramado complementario
+// al del nuevo (ver DrawAttrib::Fade); mientras dura no se elige otro nivel.
+class LodSelector {
+public:
+    static constexpr float PIXEL_ERROR = 1.0f;
+    static constexpr float HYSTERESIS = 0.25f;
+    static constexpr float FADE_SECONDS = 0.25f;
+
+    void resize(size_t count);
+    size_t size() const { return states.size(); }
+
+    // Una vez por frame antes de update: now en segundos, avanza las transiciones
+    void beginFrame(double now);
+
+    // La malla i se dibuja este frame. pixelsPerUnit: píxeles que ocupa una
+    // unidad de su espacio a la distancia de su caja (el máximo float si la
+    // cámara está encima). bias: log2 del error permitido; positivo = niveles más simples.
+    void update(size_t i, const std::vector<MeshLod>& lods, float pixelsPerUnit, float bias, bool crossfade);
+
+    // No se dibuja este frame: se termina su transición
+    void skip(size_t i);
+
+    uint32_t level(size_t i) const { return states[i].level; }
+    // El nivel que sale mientras dura la transición
+    uint32_t previous(size_t i) const { return states[i].previous; }
+    bool fading(size_t i) const { return states[i].level != states[i].previous; }
+
+    // Valor de DrawAttrib::Fade: en (0, 1) para el nivel que entra, negativo
+    // para el que sale y 0 fuera de una transición
+    float fade(size_t i, bool outgoing) const;
+
+private:
+    struct State {
+        uint8_t level = 0;
+        uint8_t previous = 0;
+        float progress = 1.0f;   // de la transición, 1 = terminada
+    };
+
+    std::vector<State> states;
+    double lastTime = -1.0;
+    float step = 0.0f;   // avance de las transiciones en este frame
+};
@@ -1,66 +1,28 @@
 #include <glad.h>
 #include "Mesh.h"
+#include "Shader.h"
 
 
 // Constructor
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures)
-{
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
-
-    this->setupMesh();
-}
-
-void Mesh::setupMesh()
-{
-    glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &this->VBO);
-    glGenBuffers(1, &this->EBO);
-
-    glBindVertexArray(this->VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
-
-    // Posición (layout = 0)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, Position));
-
-    // Normal (layout = 1)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, Normal));
-
-    // TexCoords (layout = 2)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, TexCoords));
-
-    // Tangent (layout = 3)
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, Tangent));
-
-    // Bitangent (layout = 4)
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, Bitangent));
-
-    glBindVertexArray(0);
-}
-
-
-void Mesh::Draw(GLuint shaderID)
+Mesh::Mesh(VertexFormat format, const unsigned char* vertices, size_t vertexCount, const void* indices, size_t indexCount,
+           GLenum indexType, std::vector<Texture> textures, const VertexQuantization& quantization)
 {
+    this->textures = std::move(textures);
+    this->quantization = quantization;
+    this->octNormals = withVertexLayout(format, [](auto layout) {
+        return decltype(layout)::template has<VertexAttrib::OctNormal>;
+    });
+    this->geometry = GeometryArena::instance(format).allocate(vertices, vertexCount, indices, indexCount, indexType);
+    this->lods = { MeshLod{ 0, static_cast<uint32_t>(indexCount), 0.0f } };
+
+    // Nombre del sampler de cada textura: texture_diffuse1, texture_normal1...
     unsigned int diffuseNr = 1;
     unsigned int normalNr = 1;
     unsigned int metalRoughNr = 1;
-
-    for (unsigned int i = 0; i < textures.size(); i++)
+    for (const auto& texture : this->textures)
     {
-        glActiveTexture(GL_TEXTURE0 + i);
         std::string number;
-        std::string name = textures[i].type;
+        const std::string& name = texture.type;
 
         if (name == "texture_diffuse")
             number = std::to_string(diffuseNr++);
@@ -71,14 +33,49 @@ void Mesh::Draw(GLuint shaderID)
         else
             number = "1"; // por defecto
 
-        std::string uniformName = name + number;
-        glUniform1i(glGetUniformLocation(shaderID, uniformName.c_str()), i);
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        samplers.push_back(uniformHash(name + number));
+    }
+}
+
+
+void Mesh::bindTextures(GLuint shaderID, RenderState& state) const
+{
+    for (unsigned int i = 0; i < textures.size(); i++) {
+        state.setInt(Shader::uniformLocation(shaderID, UniformId(samplers[i])), static_cast<GLint>(i));
+        state.bindTexture(i, GL_TEXTURE_2D_ARRAY, textures[i].array);
     }
+}
 
-    glBindVertexArray(this->VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+glm::vec4 Mesh::layers() const
+{
+    static const char* const TYPES[4] = { "texture_diffuse", "texture_normal", "texture_metallicRoughness", "texture_emissive" };
+    glm::vec4 result(0.0f);
+    for (int k = 0; k < 4; k++) {
+        for (const auto& texture : textures) {
+            if (texture.type == TYPES[k]) {
+                result[k] = static_cast<float>(texture.layer);
+                break;
+            }
+        }
+    }
+    return result;
+}
 
-    glActiveTexture(GL_TEXTURE0);
+void Mesh::Draw(GLuint shaderID, RenderState& state, uint32_t object, size_t level, float fade)
+{
+    bindTextures(shaderID, state);
+
+    // Valores por dibujo (ver DrawAttrib): decodificación de vértices cuantizados
+    // (identidad para los layouts de floats), capas de las texturas y transformación
+    glVertexAttrib3fv(DrawAttrib::Scale, &quantization.scale[0]);
+    glVertexAttrib3fv(DrawAttrib::Offset, &quantization.offset[0]);
+    glm::vec4 textureLayers = layers();
+    glVertexAttrib4fv(DrawAttrib::Layer, &textureLayers[0]);
+    glVertexAttrib1f(DrawAttrib::Object, static_cast<float>(object));
+    glVertexAttrib1f(DrawAttrib::Fade, fade);
+
+    const MeshLod& lod = lods[level];
+    const void* offset = reinterpret_cast<const void*>((size_t(geometry.firstIndex) + lod.firstIndex) * indexSize(geometry.indexType));
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), geometry.indexType, offset, geometry.baseVertex);
+    state.countDraw();
 }
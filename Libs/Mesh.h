@@ -6,40 +6,89 @@
 
 #include <vector>
 #include <string>
+#include "GeometryArena.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "RenderQueue.h"
+#include "VertexLayout.h"
 
-// Estructuras para almacenar datos de vértices
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
-    glm::vec3 Tangent;
-    glm::vec3 Bitangent;
-};
+// Índices de 16 bits cuando la malla tiene hasta 65536 vértices (la mitad de memoria y de ancho de banda)
+inline GLenum indexTypeFor(size_t vertexCount) {
+    return vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+inline size_t indexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(GLuint);
+}
 
 struct Texture {
-    GLuint id;
+    GLuint id;            // identificador en TextureCache (0 = sin cargar)
     std::string type;
     std::string path;
+    GLuint array = 0;     // GL_TEXTURE_2D_ARRAY compartido y capa dentro de él
+    GLint layer = 0;
 };
 
+// Nodo de la jerarquía que conserva su transformación en tiempo de ejecución
+// (animado). El resto de los nodos se hornea en los vértices al importar.
+struct ModelNode {
+    std::string name;
+    int parent = -1;                  // índice de otro nodo dinámico, siempre menor; -1 = raíz del modelo
+    glm::mat4 local = glm::mat4(1.0f); // relativa al padre dinámico (incluye los nodos estáticos intermedios)
+    glm::mat4 world = glm::mat4(1.0f); // en el espacio del modelo; la calcula Model::updateNodes
+};
+
+// Malla ya convertida en CPU, antes de subirla a la GPU
+struct MeshData {
+    std::vector<unsigned char> vertices;   // empaquetados según el VertexFormat del modelo
+    size_t vertexCount = 0;
+    VertexQuantization quantization;       // AABB de la malla si el formato está cuantizado
+    std::vector<unsigned char> indices;    // indexCount índices de tipo indexType (todos los niveles de detalle)
+    size_t indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::vector<Texture> textures;   // id = 0 hasta que se cargan
+    uint32_t features = 0;           // MaterialFeature que pide el material
+    int node = -1;                   // nodo dinámico del que cuelga; -1 = ya en el espacio del modelo
+    MeshBounds bounds;
+    MeshOptimizeReport optimization; // solo al importar; no va a la caché
+    std::vector<glm::vec3> occluder; // triángulos para SoftwareOcclusion, de a tres vértices (puede estar vacío)
+    std::vector<MeshLod> lods;       // tramos de indices, del nivel 0 al más simple (vacío = uno solo)
+    int cluster = -1;                // celda de ClusterGrid; -1 = el modelo no se partió o cuelga de un nodo dinámico
+};
+
+// Malla en la GPU: un rango dentro de la GeometryArena de su formato de vértice
 class Mesh {
 public:
     // Datos
-    std::vector<Vertex> vertices;
-    std::vector<GLuint> indices;
     std::vector<Texture> textures;
-    GLuint VAO;
+    GeometryRange geometry;
+    VertexQuantization quantization;
+    bool octNormals = false;
+    int node = -1;   // ver MeshData::node
+    int cluster = -1;   // ver MeshData::cluster
+    uint32_t features = 0;   // variante de shader (shaderVariantFor), no lo que pide el material
+    MeshBounds bounds;
+    uint32_t material = 0;   // RenderQueue::materialId de su VAO y sus arreglos de textura
+    std::vector<glm::vec3> occluder;   // ver MeshData::occluder
+    std::vector<MeshLod> lods;         // dentro de geometry; al menos el nivel 0
 
-    // Constructor
-    Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures);
+    // Constructor: copia los vértices/índices (pueden venir de la caché proyectada) a la arena
+    Mesh(VertexFormat format, const unsigned char* vertices, size_t vertexCount, const void* indices, size_t indexCount,
+         GLenum indexType, std::vector<Texture> textures, const VertexQuantization& quantization = VertexQuantization());
 
-    // Dibujar el mesh
-    void Draw(GLuint shaderProgram);
+    // Dibujar el mesh (con el programa y el VAO de la arena ya ligados, ver Model::draw).
+    // state evita volver a ligar los arreglos que ya están en su unidad.
+    // object: ranura de ObjectBuffer con su transformación; level: nivel de
+    // detalle y fade, su valor de DrawAttrib::Fade (ver LodSelector::fade)
+    void Draw(GLuint shaderProgram, RenderState& state, uint32_t object, size_t level = 0, float fade = 0.0f);
 
-private:
-    // OpenGL buffers
-    GLuint VBO, EBO;
+    // Liga los arreglos de textura y fija los samplers (sin dibujar)
+    void bindTextures(GLuint shaderProgram, RenderState& state) const;
 
-    // Inicializar buffers y atributos
-    void setupMesh();
+    // Capa de la primera textura de cada tipo que leen las variantes del shader:
+    // difusa, normal, metallicRoughness y emisiva (0 si no tiene)
+    glm::vec4 layers() const;
+
+private:
+    std::vector<uint32_t> samplers;   // uniformHash del sampler de cada textura
 };
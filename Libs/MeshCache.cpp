@@ -0,0 +1,361 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char MAGIC[4] = { 'S', 'T', 'M', 'C' };
+
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexFormat;
+        uint32_t vertexStride;
+        uint32_t importFlags;
+        float up[3];
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t binSize;
+        int64_t binTime;
+        uint64_t sourceHash;
+        uint32_t meshCount;
+        uint32_t textureCount;
+        uint32_t nodeCount;
+        uint32_t lodCount;
+        uint64_t meshOffset;
+        uint64_t textureOffset;
+        uint64_t nodeOffset;
+        uint64_t lodOffset;
+        uint64_t stringOffset;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t occluderOffset;
+        uint64_t fileSize;
+    };
+
+    struct CacheMeshRecord {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t indexByteOffset;   // desde indexOffset, alineado a 4 bytes
+        uint32_t indexCount;
+        uint32_t indexType;
+        uint32_t firstTexture;
+        uint32_t textureCount;
+        uint32_t features;
+        int32_t node;
+        float quantizationScale[3];
+        float quantizationOffset[3];
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t firstOccluderVertex;   // desde occluderOffset, en vértices de 3 floats
+        uint32_t occluderTriangles;
+        uint32_t firstLod;              // desde lodOffset; 0 niveles = solo el nivel 0
+        uint32_t lodCount;
+        int32_t cluster;
+    };
+
+    struct CacheNodeRecord {
+        int32_t parent;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        float local[16];
+    };
+
+    struct CacheTextureRecord {
+        uint32_t typeOffset;
+        uint32_t typeLength;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    // Los oclusores se guardan como arreglos de glm::vec3 tal cual
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 con relleno");
+    // y los niveles de detalle, como arreglos de MeshLod
+    static_assert(sizeof(MeshLod) == 3 * sizeof(uint32_t), "MeshLod con relleno");
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // FNV-1a sobre el texto del glTF (pocos KB frente a los MB del .bin)
+    uint64_t hashFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        uint64_t h = 0xCBF29CE484222325ull;
+        char buffer[64 * 1024];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            for (std::streamsize i = 0; i < in.gcount(); i++) {
+                h ^= static_cast<unsigned char>(buffer[i]);
+                h *= 0x100000001B3ull;
+            }
+        }
+        return h;
+    }
+
+    bool fileStamp(const std::filesystem::path& path, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec)
+            return false;
+        time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+}
+
+std::string MeshCache::cachePath(const std::string& sourcePath) {
+    return sourcePath + ".stmesh";
+}
+
+bool MeshCache::computeKey(const std::string& sourcePath, SourceKey& key) {
+    if (!fileStamp(sourcePath, key.sourceSize, key.sourceTime))
+        return false;
+
+    // Los glTF de Modelos/ guardan la geometría en scene.bin al lado del .gltf
+    std::filesystem::path bin = std::filesystem::path(sourcePath).replace_extension(".bin");
+    if (!fileStamp(bin, key.binSize, key.binTime)) {
+        key.binSize = 0;
+        key.binTime = 0;
+    }
+
+    key.sourceHash = hashFile(sourcePath);
+    return true;
+}
+
+bool MeshCache::write(const std::string& sourcePath, unsigned int importFlags, VertexFormat format, const std::vector<MeshData>& meshes,
+                      const std::vector<ModelNode>& nodes, const glm::vec3& up) {
+    SourceKey key;
+    if (!computeKey(sourcePath, key))
+        return false;
+
+    std::vector<CacheMeshRecord> meshRecords;
+    std::vector<CacheTextureRecord> textureRecords;
+    std::vector<MeshLod> lods;
+    std::string strings;
+    uint64_t totalVertices = 0;
+    uint64_t totalIndexBytes = 0;
+    uint64_t totalOccluderVertices = 0;
+
+    for (const auto& mesh : meshes) {
+        CacheMeshRecord record;
+        record.firstVertex = static_cast<uint32_t>(totalVertices);
+        record.vertexCount = static_cast<uint32_t>(mesh.vertexCount);
+        record.indexByteOffset = static_cast<uint32_t>(totalIndexBytes);
+        record.indexCount = static_cast<uint32_t>(mesh.indexCount);
+        record.indexType = mesh.indexType;
+        record.firstTexture = static_cast<uint32_t>(textureRecords.size());
+        record.textureCount = static_cast<uint32_t>(mesh.textures.size());
+        record.features = mesh.features;
+        record.node = mesh.node;
+        for (int k = 0; k < 3; k++) {
+            record.quantizationScale[k] = mesh.quantization.scale[k];
+            record.quantizationOffset[k] = mesh.quantization.offset[k];
+            record.boundsMin[k] = mesh.bounds.min[k];
+            record.boundsMax[k] = mesh.bounds.max[k];
+        }
+        record.firstOccluderVertex = static_cast<uint32_t>(totalOccluderVertices);
+        record.occluderTriangles = static_cast<uint32_t>(mesh.occluder.size() / 3);
+        record.firstLod = static_cast<uint32_t>(lods.size());
+        record.lodCount = static_cast<uint32_t>(mesh.lods.size());
+        record.cluster = mesh.cluster;
+        lods.insert(lods.end(), mesh.lods.begin(), mesh.lods.end());
+        meshRecords.push_back(record);
+
+        for (const auto& tex : mesh.textures) {
+            CacheTextureRecord texRecord;
+            texRecord.typeOffset = static_cast<uint32_t>(strings.size());
+            texRecord.typeLength = static_cast<uint32_t>(tex.type.size());
+            strings += tex.type;
+            texRecord.pathOffset = static_cast<uint32_t>(strings.size());
+            texRecord.pathLength = static_cast<uint32_t>(tex.path.size());
+            strings += tex.path;
+            textureRecords.push_back(texRecord);
+        }
+
+        totalVertices += mesh.vertexCount;
+        totalIndexBytes = alignUp(totalIndexBytes + mesh.indices.size(), 4);
+        totalOccluderVertices += mesh.occluder.size();
+    }
+
+    std::vector<CacheNodeRecord> nodeRecords;
+    for (const auto& node : nodes) {
+        CacheNodeRecord record;
+        record.parent = node.parent;
+        record.nameOffset = static_cast<uint32_t>(strings.size());
+        record.nameLength = static_cast<uint32_t>(node.name.size());
+        strings += node.name;
+        std::memcpy(record.local, &node.local[0][0], sizeof(record.local));
+        nodeRecords.push_back(record);
+    }
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexFormat = static_cast<uint32_t>(format);
+    header.vertexStride = static_cast<uint32_t>(vertexStride(format));
+    header.importFlags = importFlags;
+    for (int k = 0; k < 3; k++)
+        header.up[k] = up[k];
+    header.sourceSize = key.sourceSize;
+    header.sourceTime = key.sourceTime;
+    header.binSize = key.binSize;
+    header.binTime = key.binTime;
+    header.sourceHash = key.sourceHash;
+    header.meshCount = static_cast<uint32_t>(meshRecords.size());
+    header.textureCount = static_cast<uint32_t>(textureRecords.size());
+    header.nodeCount = static_cast<uint32_t>(nodeRecords.size());
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    header.meshOffset = sizeof(CacheHeader);
+    header.textureOffset = header.meshOffset + meshRecords.size() * sizeof(CacheMeshRecord);
+    header.nodeOffset = header.textureOffset + textureRecords.size() * sizeof(CacheTextureRecord);
+    header.lodOffset = header.nodeOffset + nodeRecords.size() * sizeof(CacheNodeRecord);
+    header.stringOffset = header.lodOffset + lods.size() * sizeof(MeshLod);
+    header.vertexOffset = alignUp(header.stringOffset + strings.size(), 16);
+    header.indexOffset = alignUp(header.vertexOffset + totalVertices * header.vertexStride, 16);
+    header.occluderOffset = alignUp(header.indexOffset + totalIndexBytes, 16);
+    header.fileSize = header.occluderOffset + totalOccluderVertices * sizeof(glm::vec3);
+
+    // Escribir a un temporal y renombrar, para no dejar cachés a medias
+    std::string finalPath = cachePath(sourcePath);
+    std::string tempPath = finalPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        auto pad = [&out](uint64_t target) {
+            static const char zeros[16] = {};
+            uint64_t pos = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(target - pos));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(meshRecords.data()), meshRecords.size() * sizeof(CacheMeshRecord));
+        out.write(reinterpret_cast<const char*>(textureRecords.data()), textureRecords.size() * sizeof(CacheTextureRecord));
+        out.write(reinterpret_cast<const char*>(nodeRecords.data()), nodeRecords.size() * sizeof(CacheNodeRecord));
+        out.write(reinterpret_cast<const char*>(lods.data()), lods.size() * sizeof(MeshLod));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        pad(header.vertexOffset);
+        for (const auto& mesh : meshes)
+            out.write(reinterpret_cast<const char*>(mesh.vertices.data()), static_cast<std::streamsize>(mesh.vertices.size()));
+        pad(header.indexOffset);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            pad(header.indexOffset + meshRecords[i].indexByteOffset);
+            out.write(reinterpret_cast<const char*>(meshes[i].indices.data()), static_cast<std::streamsize>(meshes[i].indices.size()));
+        }
+        pad(header.occluderOffset);
+        for (const auto& mesh : meshes)
+            out.write(reinterpret_cast<const char*>(mesh.occluder.data()), static_cast<std::streamsize>(mesh.occluder.size() * sizeof(glm::vec3)));
+        pad(header.fileSize);
+
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(finalPath, ec);
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec) {
+        std::cerr << "MeshCache: no se pudo escribir " << finalPath << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    std::cout << "MeshCache: escrita " << finalPath << " (" << header.fileSize / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+bool MeshCache::open(const std::string& sourcePath, unsigned int importFlags, VertexFormat format) {
+    close();
+
+    SourceKey key;
+    if (!computeKey(sourcePath, key))
+        return false;
+    if (!file.open(cachePath(sourcePath)))
+        return false;
+
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.data());
+    bool valid = file.size() >= sizeof(CacheHeader) &&
+                 std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->version == VERSION &&
+                 header->vertexFormat == static_cast<uint32_t>(format) &&
+                 header->vertexStride == vertexStride(format) &&
+                 header->importFlags == importFlags &&
+                 header->sourceSize == key.sourceSize &&
+                 header->sourceTime == key.sourceTime &&
+                 header->binSize == key.binSize &&
+                 header->binTime == key.binTime &&
+                 header->sourceHash == key.sourceHash &&
+                 header->fileSize == file.size();
+
+    if (!valid) {
+        std::cout << "MeshCache: " << cachePath(sourcePath) << " obsoleta, se vuelve a importar" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MeshCache::close() {
+    file.close();
+}
+
+uint32_t MeshCache::meshCount() const {
+    return reinterpret_cast<const CacheHeader*>(file.data())->meshCount;
+}
+
+CachedMesh MeshCache::mesh(uint32_t index) const {
+    const unsigned char* base = file.data();
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(base);
+    const CacheMeshRecord& record = reinterpret_cast<const CacheMeshRecord*>(base + header->meshOffset)[index];
+    const CacheTextureRecord* textureRecords = reinterpret_cast<const CacheTextureRecord*>(base + header->textureOffset);
+    const char* strings = reinterpret_cast<const char*>(base + header->stringOffset);
+
+    CachedMesh mesh;
+    mesh.vertices = base + header->vertexOffset + size_t(record.firstVertex) * header->vertexStride;
+    mesh.vertexCount = record.vertexCount;
+    mesh.indices = base + header->indexOffset + record.indexByteOffset;
+    mesh.indexCount = record.indexCount;
+    mesh.indexType = record.indexType;
+    mesh.node = record.node;
+    mesh.features = record.features;
+    mesh.quantization.scale = glm::vec3(record.quantizationScale[0], record.quantizationScale[1], record.quantizationScale[2]);
+    mesh.quantization.offset = glm::vec3(record.quantizationOffset[0], record.quantizationOffset[1], record.quantizationOffset[2]);
+    mesh.bounds.min = glm::vec3(record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]);
+    mesh.bounds.max = glm::vec3(record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]);
+    mesh.occluder = reinterpret_cast<const glm::vec3*>(base + header->occluderOffset) + record.firstOccluderVertex;
+    mesh.occluderTriangles = record.occluderTriangles;
+    mesh.lods = reinterpret_cast<const MeshLod*>(base + header->lodOffset) + record.firstLod;
+    mesh.lodCount = record.lodCount;
+    mesh.cluster = record.cluster;
+
+    for (uint32_t i = 0; i < record.textureCount; i++) {
+        const CacheTextureRecord& texRecord = textureRecords[record.firstTexture + i];
+        Texture tex;
+        tex.id = 0;
+        tex.type.assign(strings + texRecord.typeOffset, texRecord.typeLength);
+        tex.path.assign(strings + texRecord.pathOffset, texRecord.pathLength);
+        mesh.textures.push_back(tex);
+    }
+    return mesh;
+}
+
+std::vector<ModelNode> MeshCache::nodes() const {
+    const unsigned char* base = file.data();
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(base);
+    const CacheNodeRecord* records = reinterpret_cast<const CacheNodeRecord*>(base + header->nodeOffset);
+    const char* strings = reinterpret_cast<const char*>(base + header->stringOffset);
+
+    std::vector<ModelNode> nodes(header->nodeCount);
+    for (uint32_t i = 0; i < header->nodeCount; i++) {
+        nodes[i].name.assign(strings + records[i].nameOffset, records[i].nameLength);
+        nodes[i].parent = records[i].parent;
+        std::memcpy(&nodes[i].local[0][0], records[i].local, sizeof(records[i].local));
+    }
+    return nodes;
+}
+
+glm::vec3 MeshCache::up() const {
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.data());
+    return glm::vec3(header->up[0], header->up[1], header->up[2]);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Mesh.h"
+
+// Una malla dentro de la caché proyectada: apunta directamente al archivo
+struct CachedMesh {
+    const unsigned char* vertices;   // vertexCount * vertexStride(formato de la caché)
+    uint32_t vertexCount;
+    const void* indices;             // uint16_t o GLuint según indexType
+    uint32_t indexCount;
+    GLenum indexType;
+    VertexQuantization quantization;
+    int node;                        // ver MeshData::node
+    MeshBounds bounds;
+    std::vector<Texture> textures;   // id = 0, solo tipo y ruta
+    uint32_t features;               // ver MeshData::features
+    const glm::vec3* occluder;       // occluderTriangles * 3 vértices, ver MeshData::occluder
+    uint32_t occluderTriangles;
+    const MeshLod* lods;             // lodCount tramos, ver MeshData::lods
+    uint32_t lodCount;
+    int cluster;                     // ver MeshData::cluster
+};
+
+// Caché binaria de las mallas ya importadas por Assimp (scene.gltf.stmesh).
+// Guarda los arreglos finales de vértices/índices, los rangos de cada malla
+// sus texturas, sus oclusores, sus niveles de detalle, sus celdas y los nodos dinámicos; se invalida si cambia el glTF, su .bin, los flags de importación
+// o el formato de vértice.
+class MeshCache {
+public:
+    static const uint32_t VERSION = 10;
+
+    static std::string cachePath(const std::string& sourcePath);
+
+    // Escribe la caché al lado del archivo fuente
+    // up: ver ModelSource::up
+    static bool write(const std::string& sourcePath, unsigned int importFlags, VertexFormat format, const std::vector<MeshData>& meshes,
+                      const std::vector<ModelNode>& nodes, const glm::vec3& up);
+
+    // Proyecta la caché en memoria; false si no existe o está obsoleta
+    bool open(const std::string& sourcePath, unsigned int importFlags, VertexFormat format);
+    void close();
+
+    uint32_t meshCount() const;
+    CachedMesh mesh(uint32_t index) const;
+    std::vector<ModelNode> nodes() const;
+    glm::vec3 up() const;
+
+private:
+    struct SourceKey {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t binSize;
+        int64_t binTime;
+        uint64_t sourceHash;
+    };
+
+    static bool computeKey(const std::string& sourcePath, SourceKey& key);
+
+    MappedFile file;
+};
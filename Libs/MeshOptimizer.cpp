@@ -0,0 +1,332 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    // Parámetros del artículo de Forsyth ("Linear-Speed Vertex Cache Optimisation")
+    const int SCORE_CACHE_SIZE = 32;
+    const int MAX_VALENCE_SCORE = 32;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    struct ScoreTables {
+        float cache[SCORE_CACHE_SIZE];
+        float valence[MAX_VALENCE_SCORE];
+
+        ScoreTables() {
+            for (int i = 0; i < SCORE_CACHE_SIZE; i++) {
+                if (i < 3) {
+                    // Los tres vértices del último triángulo: puntaje fijo para no favorecer tiras largas
+                    cache[i] = LAST_TRIANGLE_SCORE;
+                } else {
+                    float scale = 1.0f / (SCORE_CACHE_SIZE - 3);
+                    cache[i] = std::pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+                }
+            }
+            valence[0] = 0.0f;
+            for (int i = 1; i < MAX_VALENCE_SCORE; i++)
+                valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+        }
+    };
+
+    float vertexScore(const ScoreTables& tables, int cachePosition, int remaining) {
+        if (remaining == 0)
+            return -1.0f;   // ya no lo usa ningún triángulo pendiente
+        float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+        return score + tables.valence[std::min(remaining, MAX_VALENCE_SCORE - 1)];
+    }
+
+    // Caché FIFO simulada con marcas de tiempo: una entrada vale si se escribió hace menos de size fallos
+    class FifoCache {
+    public:
+        FifoCache(size_t vertexCount, int size) : stamps(vertexCount, 0), size(static_cast<uint32_t>(size)), time(static_cast<uint32_t>(size) + 1) {}
+
+        // Devuelve true si el vértice no estaba (hay que transformarlo)
+        bool access(GLuint vertex) {
+            if (time - stamps[vertex] > size) {
+                stamps[vertex] = time++;
+                return true;
+            }
+            return false;
+        }
+
+        unsigned int triangleMisses(const GLuint* triangle) {
+            return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+        }
+
+        void reset() { time += size + 1; }
+
+    private:
+        std::vector<uint32_t> stamps;
+        uint32_t size;
+        uint32_t time;
+    };
+}
+
+void MeshOptimizeReport::add(const MeshOptimizeReport& mesh) {
+    size_t totalTriangles = triangles + mesh.triangles;
+    size_t totalVertices = vertices + mesh.vertices;
+    if (totalTriangles > 0) {
+        before.acmr = (before.acmr * triangles + mesh.before.acmr * mesh.triangles) / totalTriangles;
+        after.acmr = (after.acmr * triangles + mesh.after.acmr * mesh.triangles) / totalTriangles;
+    }
+    if (totalVertices > 0) {
+        before.atvr = (before.atvr * vertices + mesh.before.atvr * mesh.vertices) / totalVertices;
+        after.atvr = (after.atvr * vertices + mesh.after.atvr * mesh.vertices) / totalVertices;
+    }
+    triangles = totalTriangles;
+    vertices = totalVertices;
+}
+
+namespace MeshOptimizer {
+
+VertexCacheStats analyzeVertexCache(const std::vector<GLuint>& indices, size_t vertexCount, int cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0)
+        return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    size_t misses = 0;
+    size_t unique = 0;
+    for (GLuint index : indices) {
+        misses += cache.access(index);
+        if (!used[index]) {
+            used[index] = true;
+            unique++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / unique;
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    static const ScoreTables tables;
+
+    // Triángulos que usa cada vértice (lista compacta con desplazamientos)
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (GLuint index : indices)
+        remaining[index]++;
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++)
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    std::vector<GLuint> cache;
+    std::vector<GLuint> newCache;
+    cache.reserve(SCORE_CACHE_SIZE + 3);
+    newCache.reserve(SCORE_CACHE_SIZE + 3);
+
+    size_t scanCursor = 0;
+    size_t best = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        const GLuint* triangle = &indices[best * 3];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // Quitar el triángulo de la adyacencia de sus vértices
+        for (int k = 0; k < 3; k++) {
+            GLuint v = triangle[k];
+            uint32_t* begin = &adjacency[offsets[v]];
+            uint32_t* end = begin + remaining[v];
+            *std::find(begin, end, static_cast<uint32_t>(best)) = *(end - 1);
+            remaining[v]--;
+        }
+
+        // Sus vértices pasan al frente de la caché (LRU)
+        newCache.assign(triangle, triangle + 3);
+        for (GLuint v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache.push_back(v);
+        }
+        for (size_t i = SCORE_CACHE_SIZE; i < newCache.size(); i++) {
+            cachePosition[newCache[i]] = -1;
+            vertexScores[newCache[i]] = vertexScore(tables, -1, remaining[newCache[i]]);
+        }
+        if (newCache.size() > SCORE_CACHE_SIZE)
+            newCache.resize(SCORE_CACHE_SIZE);
+        cache.swap(newCache);
+
+        // Recalcular puntajes solo alrededor de la caché
+        for (size_t i = 0; i < cache.size(); i++) {
+            cachePosition[cache[i]] = static_cast<int>(i);
+            vertexScores[cache[i]] = vertexScore(tables, static_cast<int>(i), remaining[cache[i]]);
+        }
+
+        float bestScore = -1.0f;
+        best = triangleCount;
+        for (GLuint v : cache) {
+            for (uint32_t i = 0; i < remaining[v]; i++) {
+                uint32_t t = adjacency[offsets[v] + i];
+                float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                triangleScores[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        // Nada conectado con la caché: seguir por el siguiente triángulo pendiente
+        if (best == triangleCount) {
+            while (scanCursor < triangleCount && emitted[scanCursor])
+                scanCursor++;
+            best = scanCursor;
+        }
+    }
+
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    FifoCache cache(vertices.size(), CACHE_SIZE);
+
+    // 1. Cortes "duros": triángulos que fallan en los tres vértices (la caché ya se vació sola)
+    std::vector<size_t> hard;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (cache.triangleMisses(&indices[t * 3]) == 3 || t == 0)
+            hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // 2. Cortes "blandos": dentro de cada grupo, cortar en cuanto el ACMR acumulado
+    //    ya es tan bueno como el del grupo entero (multiplicado por threshold)
+    std::vector<size_t> clusters;
+    for (size_t c = 0; c + 1 < hard.size(); c++) {
+        size_t start = hard[c];
+        size_t end = hard[c + 1];
+
+        cache.reset();
+        unsigned int clusterMisses = 0;
+        for (size_t t = start; t < end; t++)
+            clusterMisses += cache.triangleMisses(&indices[t * 3]);
+        float clusterAcmr = static_cast<float>(clusterMisses) / (end - start);
+
+        cache.reset();
+        clusters.push_back(start);
+        unsigned int misses = 0;
+        size_t clusterStart = start;
+        for (size_t t = start; t < end; t++) {
+            misses += cache.triangleMisses(&indices[t * 3]);
+            if (t + 1 < end && static_cast<float>(misses) / (t + 1 - clusterStart) <= clusterAcmr * threshold) {
+                clusters.push_back(t + 1);
+                clusterStart = t + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // 3. Centro y normal de cada grupo (ponderados por área) y centro de la malla
+    size_t clusterCount = clusters.size() - 1;
+    std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const glm::vec3& a = vertices[indices[t * 3]].Position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+            glm::vec3 cross = glm::cross(b - a, d - a);
+            float area = glm::length(cross);
+            centroids[c] += (a + b + d) * (area / 3.0f);
+            normals[c] += cross;
+            clusterArea += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f)
+            centroids[c] /= clusterArea;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    // 4. Primero los grupos más "hacia afuera": tapan a los de adentro desde cualquier vista
+    std::vector<float> keys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float length = glm::length(normals[c]);
+        keys[c] = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for (size_t c : order)
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    const GLuint unused = ~0u;
+    std::vector<GLuint> remap(vertices.size(), unused);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (GLuint& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<GLuint>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+MeshOptimizeReport optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    MeshOptimizeReport report;
+    report.triangles = indices.size() / 3;
+    report.vertices = vertices.size();
+    report.before = analyzeVertexCache(indices, vertices.size());
+
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+
+    report.vertices = vertices.size();
+    report.after = analyzeVertexCache(indices, vertices.size());
+    return report;
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VertexLayout.h"
+
+// Eficiencia de la caché de vértices post-transformación (FIFO simulada)
+struct VertexCacheStats {
+    float acmr = 0.0f;   // vértices transformados por triángulo (ideal ~0.5, peor 3)
+    float atvr = 0.0f;   // vértices transformados por vértice único (ideal 1)
+};
+
+struct MeshOptimizeReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    size_t triangles = 0;
+    size_t vertices = 0;
+
+    // Acumula otra malla (ACMR ponderado por triángulos, ATVR por vértices)
+    void add(const MeshOptimizeReport& mesh);
+};
+
+// Reordenamientos de triángulos y vértices que se hacen una vez al importar.
+// Solo CPU; se puede usar desde cualquier hilo.
+namespace MeshOptimizer {
+    // Tamaño de caché con el que se miden ACMR/ATVR (GPUs actuales: 16-32 entradas)
+    const int CACHE_SIZE = 16;
+
+    VertexCacheStats analyzeVertexCache(const std::vector<GLuint>& indices, size_t vertexCount, int cacheSize = CACHE_SIZE);
+
+    // Orden de triángulos para la caché post-transformación (algoritmo de Forsyth)
+    void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount);
+
+    // Reordena grupos de triángulos para dibujar primero los que miran hacia afuera
+    // (independiente de la vista). threshold limita cuánto puede empeorar el ACMR.
+    void optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+    // Renumera los vértices en orden de primer uso y descarta los que no se usan
+    void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+    // Las tres pasadas en orden, midiendo antes y después
+    MeshOptimizeReport optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+}
@@ -0,0 +1,524 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+    // Peso de los atributos frente a la posición: un cambio de 1 en la normal
+    // (o en las coordenadas de textura) cuesta como moverse esa fracción del radio de la malla
+    const double NORMAL_WEIGHT = 0.1;
+    const double UV_WEIGHT = 0.05;
+    // Las aristas de borde suman un plano perpendicular a su cara para que el borde no se encoja
+    const double BORDER_WEIGHT = 10.0;
+    // Se rechaza un colapso que gira una cara vecina más que esto (coseno)
+    const float MIN_FLIP_COSINE = 0.25f;
+    // Error máximo de un nivel, en radios de la malla
+    const float MAX_RELATIVE_ERROR = 0.05f;
+    // Un nivel tiene que dejar como mucho esta fracción de los triángulos del anterior
+    const float MAX_KEPT_FRACTION = 0.8f;
+
+    const int DIM = 8;                        // posición, normal y coordenadas de textura
+    const int PACKED = DIM * (DIM + 1) / 2;   // triángulo superior de una matriz simétrica
+
+    // Cuádrica generalizada: suma (ponderada por área) de las distancias al
+    // cuadrado a los planos de los triángulos en el espacio de DIM dimensiones.
+    // error(v) = vᵀAv + 2bᵀv + c; A por filas del triángulo superior
+    struct Quadric {
+        double a[PACKED] = {};
+        double b[DIM] = {};
+        double c = 0.0;
+        double weight = 0.0;
+
+        void add(const Quadric& other) {
+            for (int i = 0; i < PACKED; i++)
+                a[i] += other.a[i];
+            for (int i = 0; i < DIM; i++)
+                b[i] += other.b[i];
+            c += other.c;
+            weight += other.weight;
+        }
+
+        double evaluate(const double* v) const {
+            double result = c;
+            int k = 0;
+            for (int i = 0; i < DIM; i++) {
+                result += a[k++] * v[i] * v[i];
+                for (int j = i + 1; j < DIM; j++)
+                    result += 2.0 * a[k++] * v[i] * v[j];
+                result += 2.0 * b[i] * v[i];
+            }
+            return result;
+        }
+
+        // Plano que solo depende de la posición: n·p + d = 0, con peso w
+        void addPlane(const glm::dvec3& n, double d, double w) {
+            int k = 0;
+            for (int i = 0; i < DIM; i++) {
+                for (int j = i; j < DIM; j++, k++) {
+                    if (i < 3 && j < 3)
+                        a[k] += w * n[i] * n[j];
+                }
+            }
+            for (int i = 0; i < 3; i++)
+                b[i] += w * d * n[i];
+            c += w * d * d;
+        }
+
+        // Triángulo pqr en DIM dimensiones: A = I - e1e1ᵀ - e2e2ᵀ con e1, e2 una base de su plano
+        void addTriangle(const double* p, const double* q, const double* r, double area) {
+            double e1[DIM], e2[DIM];
+            double length1 = 0.0;
+            for (int i = 0; i < DIM; i++) {
+                e1[i] = q[i] - p[i];
+                length1 += e1[i] * e1[i];
+            }
+            if (length1 <= 0.0)
+                return;
+            length1 = std::sqrt(length1);
+            double along = 0.0;
+            for (int i = 0; i < DIM; i++) {
+                e1[i] /= length1;
+                e2[i] = r[i] - p[i];
+                along += e1[i] * e2[i];
+            }
+            double length2 = 0.0;
+            for (int i = 0; i < DIM; i++) {
+                e2[i] -= along * e1[i];
+                length2 += e2[i] * e2[i];
+            }
+            if (length2 <= 0.0)
+                return;
+            length2 = std::sqrt(length2);
+
+            double pe1 = 0.0, pe2 = 0.0, pp = 0.0;
+            for (int i = 0; i < DIM; i++) {
+                e2[i] /= length2;
+                pe1 += p[i] * e1[i];
+                pe2 += p[i] * e2[i];
+                pp += p[i] * p[i];
+            }
+
+            int k = 0;
+            for (int i = 0; i < DIM; i++) {
+                for (int j = i; j < DIM; j++, k++)
+                    a[k] += area * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+                b[i] += area * (pe1 * e1[i] + pe2 * e2[i] - p[i]);
+            }
+            c += area * (pp - pe1 * pe1 - pe2 * pe2);
+            weight += area;
+        }
+    };
+
+    // La cuádrica clásica, solo de planos 3D: da el error geométrico de cada nivel
+    struct PlaneQuadric {
+        double a[6] = {};   // xx xy xz yy yz zz
+        double b[3] = {};
+        double c = 0.0;
+        double weight = 0.0;
+
+        void add(const PlaneQuadric& other) {
+            for (int i = 0; i < 6; i++)
+                a[i] += other.a[i];
+            for (int i = 0; i < 3; i++)
+                b[i] += other.b[i];
+            c += other.c;
+            weight += other.weight;
+        }
+
+        void addPlane(const glm::dvec3& n, double d, double w) {
+            a[0] += w * n.x * n.x; a[1] += w * n.x * n.y; a[2] += w * n.x * n.z;
+            a[3] += w * n.y * n.y; a[4] += w * n.y * n.z; a[5] += w * n.z * n.z;
+            b[0] += w * d * n.x; b[1] += w * d * n.y; b[2] += w * d * n.z;
+            c += w * d * d;
+        }
+
+        double evaluate(const glm::dvec3& p) const {
+            return a[0] * p.x * p.x + a[3] * p.y * p.y + a[5] * p.z * p.z +
+                   2.0 * (a[1] * p.x * p.y + a[2] * p.x * p.z + a[4] * p.y * p.z) +
+                   2.0 * (b[0] * p.x + b[1] * p.y + b[2] * p.z) + c;
+        }
+    };
+
+    uint64_t edgeKey(GLuint a, GLuint b) {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    // Estado del colapso de aristas; se conserva entre niveles para que las
+    // cuádricas acumulen el error de todos los colapsos desde el nivel 0.
+    // Un colapso mueve una posición entera: todas sus copias (vértices con la
+    // misma posición y distinta normal o coordenada de textura, las costuras)
+    // pasan a una copia vecina de la otra punta, así las costuras no se abren.
+    class Simplifier {
+    public:
+        Simplifier(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+
+        float reduce(std::vector<GLuint>& indices, size_t targetIndexCount, float maxError);
+
+    private:
+        // Por posición: Manifold se puede colapsar hacia cualquier vecino; Border,
+        // solo por su borde; Locked no se mueve (esquinas del borde, aristas no manifold)
+        enum class Kind : uint8_t { Manifold, Border, Locked };
+
+        struct Collapse {
+            GLuint from;
+            GLuint to;
+            double cost;
+        };
+
+        using WedgePairs = std::vector<std::pair<GLuint, GLuint>>;
+
+        bool matchWedges(const std::vector<GLuint>& indices, GLuint from, GLuint to, WedgePairs& pairs) const;
+        double collapseCost(const WedgePairs& pairs) const;
+        double geometricError(const WedgePairs& pairs) const;
+        bool flips(const std::vector<GLuint>& indices, const WedgePairs& pairs) const;
+
+        const std::vector<Vertex>& vertices;
+        std::vector<GLuint> position;        // id de posición: el primer vértice en ese punto
+        std::vector<GLuint> nextWedge;       // lista circular de los vértices de cada posición
+        std::vector<Kind> kinds;             // el de su posición
+        std::vector<double> attributes;      // DIM por vértice, ya con los pesos
+        std::vector<Quadric> quadrics;
+        std::vector<PlaneQuadric> planes;
+        float error = 0.0f;
+
+        // Caras de cada vértice en la pasada actual (CSR)
+        std::vector<uint32_t> offsets;
+        std::vector<GLuint> adjacency;
+    };
+
+    Simplifier::Simplifier(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+        : vertices(vertices), position(vertices.size()), nextWedge(vertices.size()), kinds(vertices.size(), Kind::Manifold),
+          attributes(vertices.size() * DIM), quadrics(vertices.size()), planes(vertices.size())
+    {
+        // Vértices en el mismo punto
+        std::vector<GLuint> order(vertices.size());
+        std::iota(order.begin(), order.end(), 0u);
+        auto less = [&vertices](GLuint a, GLuint b) {
+            const glm::vec3& pa = vertices[a].Position;
+            const glm::vec3& pb = vertices[b].Position;
+            return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), less);
+        for (size_t i = 0; i < order.size(); i++) {
+            GLuint v = order[i];
+            bool same = i > 0 && vertices[v].Position == vertices[order[i - 1]].Position;
+            position[v] = same ? position[order[i - 1]] : v;
+            // Se inserta después del primero de su posición
+            nextWedge[v] = same ? nextWedge[position[v]] : v;
+            if (same)
+                nextWedge[position[v]] = v;
+        }
+
+        // Bordes y aristas no manifold, sobre las posiciones (una costura no es un borde)
+        std::unordered_map<uint64_t, uint32_t> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            GLuint a = position[indices[i]];
+            GLuint b = position[indices[i - i % 3 + (i + 1) % 3]];
+            edges[edgeKey(a, b)]++;
+        }
+        std::vector<uint32_t> borderEdges(vertices.size(), 0);
+        for (const auto& [key, count] : edges) {
+            GLuint a = static_cast<GLuint>(key >> 32);
+            GLuint b = static_cast<GLuint>(key & 0xFFFFFFFFu);
+            if (count == 1) {
+                borderEdges[a]++;
+                borderEdges[b]++;
+            } else if (count > 2) {
+                borderEdges[a] += 3;   // no manifold: se bloquea
+                borderEdges[b] += 3;
+            }
+        }
+        for (size_t v = 0; v < vertices.size(); v++) {
+            uint32_t count = borderEdges[position[v]];
+            if (count == 2)
+                kinds[v] = Kind::Border;
+            else if (count != 0)
+                kinds[v] = Kind::Locked;
+        }
+
+        // Atributos con sus pesos, relativos al radio de la malla
+        glm::vec3 min(0.0f), max(0.0f);
+        if (!vertices.empty()) {
+            min = max = vertices[0].Position;
+            for (const Vertex& vertex : vertices) {
+                min = glm::min(min, vertex.Position);
+                max = glm::max(max, vertex.Position);
+            }
+        }
+        double radius = std::max(0.5 * glm::length(max - min), 1e-6);
+        for (size_t v = 0; v < vertices.size(); v++) {
+            double* out = &attributes[v * DIM];
+            for (int k = 0; k < 3; k++) {
+                out[k] = vertices[v].Position[k];
+                out[3 + k] = vertices[v].Normal[k] * NORMAL_WEIGHT * radius;
+            }
+            out[6] = vertices[v].TexCoords.x * UV_WEIGHT * radius;
+            out[7] = vertices[v].TexCoords.y * UV_WEIGHT * radius;
+        }
+
+        // Cuádricas de cada triángulo en sus tres vértices, más los planos de borde
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const GLuint corner[3] = { indices[i], indices[i + 1], indices[i + 2] };
+            glm::dvec3 p[3];
+            for (int k = 0; k < 3; k++)
+                p[k] = glm::dvec3(vertices[corner[k]].Position);
+            glm::dvec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            double length = glm::length(normal);
+            if (length <= 0.0)
+                continue;
+            double area = 0.5 * length;
+            normal /= length;
+            double d = -glm::dot(normal, p[0]);
+
+            Quadric triangle;
+            triangle.addTriangle(&attributes[corner[0] * DIM], &attributes[corner[1] * DIM], &attributes[corner[2] * DIM], area);
+            PlaneQuadric plane;
+            plane.addPlane(normal, d, area);
+            plane.weight = area;
+            for (GLuint v : corner) {
+                quadrics[v].add(triangle);
+                planes[v].add(plane);
+            }
+
+            for (int k = 0; k < 3; k++) {
+                GLuint a = corner[k], b = corner[(k + 1) % 3];
+                if (edges[edgeKey(position[a], position[b])] != 1)
+                    continue;
+                glm::dvec3 edge = p[(k + 1) % 3] - p[k];
+                glm::dvec3 side = glm::cross(edge, normal);
+                double sideLength = glm::length(side);
+                if (sideLength <= 0.0)
+                    continue;
+                side /= sideLength;
+                double w = BORDER_WEIGHT * glm::dot(edge, edge);
+                double sideD = -glm::dot(side, p[k]);
+                for (GLuint v : { a, b }) {
+                    quadrics[v].addPlane(side, sideD, w);
+                    planes[v].addPlane(side, sideD, w);
+                }
+            }
+        }
+    }
+
+    // Para mover la posición de from a la de to: cada copia de from con la copia
+    // de to que comparte alguna cara con ella. false si una no tiene ninguna
+    // (to está del otro lado de una costura que pasa por from)
+    bool Simplifier::matchWedges(const std::vector<GLuint>& indices, GLuint from, GLuint to, WedgePairs& pairs) const {
+        pairs.clear();
+        pairs.emplace_back(from, to);
+        for (GLuint wedge = nextWedge[from]; wedge != from; wedge = nextWedge[wedge]) {
+            uint32_t first = offsets[wedge], last = offsets[wedge + 1];
+            if (first == last)
+                continue;   // ya sin caras
+            GLuint target = wedge;
+            for (uint32_t f = first; f < last && target == wedge; f++) {
+                const GLuint* triangle = &indices[size_t(adjacency[f]) * 3];
+                for (int k = 0; k < 3; k++) {
+                    if (position[triangle[k]] == position[to])
+                        target = triangle[k];
+                }
+            }
+            if (target == wedge)
+                return false;
+            pairs.emplace_back(wedge, target);
+        }
+        return true;
+    }
+
+    // Error medio (por unidad de área) de juntar cada copia con su pareja, en el espacio con atributos
+    double Simplifier::collapseCost(const WedgePairs& pairs) const {
+        double cost = 0.0, weight = 0.0;
+        for (const auto& [from, to] : pairs) {
+            const double* target = &attributes[to * DIM];
+            cost += quadrics[from].evaluate(target) + quadrics[to].evaluate(target);
+            weight += quadrics[from].weight + quadrics[to].weight;
+        }
+        return weight > 0.0 ? std::max(cost, 0.0) / weight : 0.0;
+    }
+
+    // Lo mismo solo con la posición, como distancia
+    double Simplifier::geometricError(const WedgePairs& pairs) const {
+        glm::dvec3 target(vertices[pairs.front().second].Position);
+        double cost = 0.0, weight = 0.0;
+        for (const auto& [from, to] : pairs) {
+            cost += planes[from].evaluate(target) + planes[to].evaluate(target);
+            weight += planes[from].weight + planes[to].weight;
+        }
+        return weight > 0.0 ? std::sqrt(std::max(cost, 0.0) / weight) : 0.0;
+    }
+
+    // Alguna cara que no desaparece queda dada vuelta (o casi) al mover la posición
+    bool Simplifier::flips(const std::vector<GLuint>& indices, const WedgePairs& pairs) const {
+        GLuint destination = position[pairs.front().second];
+        const glm::vec3& source = vertices[pairs.front().first].Position;
+        const glm::vec3& target = vertices[destination].Position;
+        for (const auto& [from, to] : pairs) {
+            for (uint32_t f = offsets[from]; f < offsets[from + 1]; f++) {
+                const GLuint* triangle = &indices[size_t(adjacency[f]) * 3];
+                int k = triangle[0] == from ? 0 : triangle[1] == from ? 1 : 2;
+                GLuint a = triangle[(k + 1) % 3], b = triangle[(k + 2) % 3];
+                if (position[a] == destination || position[b] == destination)
+                    continue;   // esta cara desaparece
+                const glm::vec3& pa = vertices[a].Position;
+                const glm::vec3& pb = vertices[b].Position;
+                glm::vec3 before = glm::cross(pa - source, pb - source);
+                glm::vec3 after = glm::cross(pa - target, pb - target);
+                if (glm::dot(before, after) < MIN_FLIP_COSINE * glm::length(before) * glm::length(after))
+                    return true;
+                // Tampoco puede quedar de espaldas a las normales de sus vértices (se vería mal iluminada)
+                if (glm::dot(after, vertices[to].Normal + vertices[a].Normal + vertices[b].Normal) <= 0.0f)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // Por pasadas: se ordenan todos los colapsos posibles por costo y se hacen
+    // en orden los que no tocan una posición ya movida en la pasada
+    float Simplifier::reduce(std::vector<GLuint>& indices, size_t targetIndexCount, float maxError) {
+        std::vector<bool> touched(vertices.size());
+        std::unordered_map<uint64_t, uint32_t> edges;
+        std::vector<Collapse> collapses;
+        WedgePairs pairs;
+        offsets.resize(vertices.size() + 1);
+
+        while (indices.size() > targetIndexCount) {
+            size_t triangleCount = indices.size() / 3;
+
+            std::fill(offsets.begin(), offsets.end(), 0u);
+            for (GLuint v : indices)
+                offsets[v + 1]++;
+            for (size_t v = 0; v < vertices.size(); v++)
+                offsets[v + 1] += offsets[v];
+            adjacency.resize(indices.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                adjacency[fill[indices[i]]++] = static_cast<GLuint>(i / 3);
+
+            // Aristas de borde del nivel actual (las dos puntas tienen que ser de borde o bloqueadas)
+            edges.clear();
+            for (size_t i = 0; i < indices.size(); i++) {
+                GLuint a = indices[i];
+                GLuint b = indices[i - i % 3 + (i + 1) % 3];
+                if (kinds[a] != Kind::Manifold && kinds[b] != Kind::Manifold)
+                    edges[edgeKey(position[a], position[b])]++;
+            }
+
+            // Una arista interior aparece en sus dos caras: se toma una sola vez
+            collapses.clear();
+            for (size_t i = 0; i < indices.size(); i++) {
+                GLuint a = indices[i];
+                GLuint b = indices[i - i % 3 + (i + 1) % 3];
+                bool border = kinds[a] != Kind::Manifold && kinds[b] != Kind::Manifold &&
+                              edges[edgeKey(position[a], position[b])] == 1;
+                if (!border && position[a] > position[b])
+                    continue;
+                auto allowed = [&](GLuint from, GLuint to) {
+                    return kinds[from] == Kind::Manifold || (kinds[from] == Kind::Border && border && kinds[to] != Kind::Manifold);
+                };
+                double best = -1.0;
+                for (auto [from, to] : { std::pair<GLuint, GLuint>(a, b), std::pair<GLuint, GLuint>(b, a) }) {
+                    if (!allowed(from, to) || !matchWedges(indices, from, to, pairs))
+                        continue;
+                    double cost = collapseCost(pairs);
+                    if (best < 0.0 || cost < best) {
+                        if (best >= 0.0)
+                            collapses.pop_back();
+                        collapses.push_back(Collapse{ from, to, cost });
+                        best = cost;
+                    }
+                }
+            }
+            if (collapses.empty())
+                break;
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            // Cada colapso saca unas dos caras: no pasarse mucho del objetivo
+            size_t goal = std::max<size_t>((triangleCount - targetIndexCount / 3) / 2, 1);
+            size_t done = 0;
+            std::fill(touched.begin(), touched.end(), false);
+            for (const Collapse& collapse : collapses) {
+                if (done >= goal)
+                    break;
+                if (touched[position[collapse.from]] || touched[position[collapse.to]])
+                    continue;
+                if (!matchWedges(indices, collapse.from, collapse.to, pairs))
+                    continue;
+                double distance = geometricError(pairs);
+                if (distance > maxError || flips(indices, pairs))
+                    continue;
+
+                for (const auto& [from, to] : pairs) {
+                    for (uint32_t f = offsets[from]; f < offsets[from + 1]; f++) {
+                        GLuint* triangle = &indices[size_t(adjacency[f]) * 3];
+                        for (int k = 0; k < 3; k++) {
+                            if (triangle[k] == from)
+                                triangle[k] = to;
+                        }
+                    }
+                    quadrics[to].add(quadrics[from]);
+                    planes[to].add(planes[from]);
+                }
+                error = std::max(error, static_cast<float>(distance));
+                touched[position[collapse.from]] = touched[position[collapse.to]] = true;
+                done++;
+            }
+            if (done == 0)
+                break;
+
+            // Quitar las caras que quedaron sin área
+            size_t kept = 0;
+            for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                GLuint a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c])
+                    continue;
+                indices[kept++] = a;
+                indices[kept++] = b;
+                indices[kept++] = c;
+            }
+            indices.resize(kept);
+        }
+        return error;
+    }
+}
+
+float MeshSimplifier::simplify(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, size_t targetIndexCount, float maxError) {
+    Simplifier simplifier(vertices, indices);
+    return simplifier.reduce(indices, targetIndexCount, maxError);
+}
+
+std::vector<MeshLod> MeshSimplifier::buildLods(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    std::vector<MeshLod> lods{ MeshLod{ 0, static_cast<uint32_t>(indices.size()), 0.0f } };
+    if (indices.size() / 3 < MIN_TRIANGLES)
+        return lods;
+
+    glm::vec3 min = vertices[indices[0]].Position, max = min;
+    for (GLuint v : indices) {
+        min = glm::min(min, vertices[v].Position);
+        max = glm::max(max, vertices[v].Position);
+    }
+    float maxError = MAX_RELATIVE_ERROR * 0.5f * glm::length(max - min);
+
+    Simplifier simplifier(vertices, indices);
+    std::vector<GLuint> current(indices);
+    while (lods.size() < MAX_LODS) {
+        size_t previous = current.size();
+        float error = simplifier.reduce(current, previous / 6 * 3, maxError);
+        if (current.empty() || current.size() > previous * MAX_KEPT_FRACTION)
+            break;
+
+        // El orden de los colapsos no sirve para la caché: cada nivel se reordena por separado
+        std::vector<GLuint> level(current);
+        MeshOptimizer::optimizeVertexCache(level, vertices.size());
+        lods.push_back(MeshLod{ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(level.size()),
+                                std::max(error, lods.back().error) });
+        indices.insert(indices.end(), level.begin(), level.end());
+        if (current.size() / 3 < MIN_TRIANGLES)
+            break;
+    }
+    return lods;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VertexLayout.h"
+
+// Nivel de detalle de una malla: un tramo de sus índices sobre los mismos vértices
+struct MeshLod {
+    uint32_t firstIndex;   // desde el primer índice de la malla
+    uint32_t indexCount;
+    float error;           // desvío estimado respecto del nivel 0, en unidades de la malla (0 en el nivel 0)
+};
+
+// Niveles de detalle que se generan una vez al importar, colapsando aristas
+// según cuádricas de error (Garland-Heckbert) extendidas a la normal y a las
+// coordenadas de textura. Los vértices no se mueven: cada colapso junta un
+// vértice con un vecino, así todos los niveles comparten el VBO de la malla.
+// Solo CPU; se puede usar desde cualquier hilo.
+namespace MeshSimplifier {
+    // El nivel 0 y hasta tres simplificados, cada uno con la mitad de triángulos que el anterior
+    const size_t MAX_LODS = 4;
+    // Las mallas con menos triángulos quedan con el nivel 0 solo
+    const size_t MIN_TRIANGLES = 64;
+
+    // Colapsa aristas de indices hasta dejar targetIndexCount índices o hasta
+    // que ningún colapso quede por debajo de maxError (en unidades de la malla).
+    // Devuelve el error alcanzado.
+    float simplify(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, size_t targetIndexCount, float maxError);
+
+    // indices tiene el nivel 0; le agrega detrás los niveles simplificados
+    // (ordenados para la caché de vértices) y devuelve los tramos de todos.
+    // Se corta antes si un nivel ya no saca suficientes triángulos.
+    std::vector<MeshLod> buildLods(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+}
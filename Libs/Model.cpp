@@ -1,77 +1,729 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
-#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include "LoadProfiler.h"
 #include "Model.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjectBuffer.h"
+#include "Shader.h"
+#include "TextureCache.h"
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
 #include <gtx/matrix_major_storage.hpp>
+#include <assimp/GltfMaterial.h>
 
 
-Model::Model(const std::string& path) {
-    loadModel(path);
+Model::Model(const std::string& path, VertexFormat format) {
+    loadModel(path, format);
 }
 
-void Model::Draw(GLuint shaderProgram) {
+Model::Model() = default;
+
+DrawPath Model::drawPath = DrawPath::MultiDrawIndirect;
+bool Model::hierarchicalCulling = true;
+bool Model::occlusionCulling = true;
+bool Model::softwareOcclusion = true;
+bool Model::levelOfDetail = true;
+float Model::lodBias = 0.0f;
+bool Model::lodCrossfade = true;
+bool Model::useImpostors = true;
+float Model::impostorPixels = 64.0f;
+
+Model::~Model() {
+    // Devolver las referencias al registro de texturas y el espacio en la arena
     for (auto& mesh : meshes) {
-        mesh.Draw(shaderProgram);
+        for (auto& tex : mesh.textures)
+            TextureCache::instance().release(tex.id);
+        GeometryArena::instance(format).release(mesh.geometry);
+    }
+    if (objectCount > 0)
+        ObjectBuffer::instance().release(objectBase, objectCount);
+}
+
+void Model::submit(RenderQueue& queue, ShaderVariants& shaders, const glm::mat4& modelMatrix) {
+    if (meshes.empty())
+        return;
+    if (nodesDirty)
+        updateNodes();
+
+    // Transformaciones del frame: el modelo entero y cada nodo dinámico
+    ObjectBuffer& objects = ObjectBuffer::instance();
+    objects.setModel(objectBase, modelMatrix);
+    for (size_t n = 0; n < nodes.size(); n++)
+        objects.setModel(objectBase + 1 + static_cast<uint32_t>(n), modelMatrix * nodes[n].world);
+
+    // Todas las mallas comparten el VAO de la arena
+    GLuint vertexArray = GeometryArena::instance(format).vertexArray();
+
+    // Culling: el BVH en el espacio del modelo o una pasada por tramo, con los
+    // planos llevados al espacio de sus cajas
+    // (solo con todas las mallas subidas: antes no hay cajas)
+    const CullView* culling = meshVisibility.size() == meshes.size() ? queue.culling() : nullptr;
+    lastCull = CullStats();
+    if (culling && hierarchicalCulling) {
+        if (bvhDirty)
+            updateBvh();
+        lastCull = bvh.cull(culling->toObject(modelMatrix), meshVisibility);
+    } else if (culling) {
+        for (const CullRange& range : cullRanges) {
+            CullView view = culling->toObject(objects.model(objectBase + static_cast<uint32_t>(range.node + 1)));
+            lastCull += cullBounds(cullVolumes, range.first, range.count, view, meshVisibility);
+        }
+    }
+    // Los clusters que pasan a impostor ya no piden consultas de oclusión ni niveles
+    bool filtered = selectImpostors(meshVisibility.size() == meshes.size() ? queue.detailView() : nullptr, culling != nullptr,
+                                    modelMatrix) || culling != nullptr;
+    if (culling && softwareOcclusion && SoftwareOcclusion::instance().ready())
+        cullSoftwareOccluded(SoftwareOcclusion::instance());
+    if (culling && occlusionCulling)
+        cullOccluded(*culling, modelMatrix);
+    selectLods(levelOfDetail ? queue.detailView() : nullptr, modelMatrix, filtered);
+    uint32_t fadeVariant = lodCrossfade ? MaterialFeature::LodFade : 0;
+
+    // Las mallas estáticas salen de la lista guardada (un paquete por variante de shader);
+    // las de nodos dinámicos, una por una
+    bool cached = drawPath != DrawPath::MeshLoop;
+    if (cached) {
+        if (drawListDirty) {
+            staticDraws.build(meshes, visible, objectBase);
+            drawListDirty = false;
+        }
+        staticDraws.cull(filtered ? &meshVisibility : nullptr, &lodSelector);
+        glm::vec3 center(modelMatrix * glm::vec4(staticBounds.center(), 1.0f));
+        for (size_t group = 0; group < staticDraws.groupCount(); group++) {
+            if (staticDraws.groupVisibleCount(group) == 0)
+                continue;
+            GLuint program = shaders.get(staticDraws.groupFeatures(group) | fadeVariant).Program;
+            RenderPacket packet{ this, STATIC_DRAWS | static_cast<uint32_t>(group), program, vertexArray };
+            queue.submit(RenderPass::Opaque, staticMaterial, center, packet);
+        }
     }
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        if ((cached && mesh.node < 0) || (i < visible.size() && !visible[i]))
+            continue;
+        if (filtered && !meshVisibility.test(i))
+            continue;
+        const glm::mat4& transform = objects.model(objectSlot(mesh));
+        glm::vec3 center(transform * glm::vec4(mesh.bounds.center(), 1.0f));
+        RenderPacket packet{ this, static_cast<uint32_t>(i), shaders.get(mesh.features | fadeVariant).Program, vertexArray };
+        queue.submit(RenderPass::Opaque, mesh.material, center, packet);
+        if (lodSelector.fading(i)) {
+            packet.item |= OUTGOING_LOD;
+            queue.submit(RenderPass::Opaque, mesh.material, center, packet);
+        }
+    }
+
+    if (impostors.instanceCount() > 0) {
+        glm::vec3 center(modelMatrix * glm::vec4(staticBounds.center(), 1.0f));
+        RenderPacket packet{ this, IMPOSTORS, impostors.program(), impostors.vertexArray() };
+        queue.submit(RenderPass::Opaque, impostors.material(), center, packet);
+    }
+}
+
+void Model::Draw(ShaderVariants& shaders, const glm::mat4& modelMatrix) {
+    // Sin cámara: el orden solo agrupa por material
+    RenderQueue queue;
+    queue.begin(glm::vec3(0.0f), 1.0f);
+    submit(queue, shaders, modelMatrix);
+    ObjectBuffer::instance().upload();
+    queue.execute();
+}
+
+void Model::draw(const RenderPacket& packet, RenderState& state) {
+    if (packet.item == IMPOSTORS) {
+        impostors.draw(state, objectBase);
+        return;
+    }
+    if (packet.program != uniformProgram) {
+        uniformProgram = packet.program;
+        objectsLocation = Shader::uniformLocation(packet.program, "objects");
+        octNormalsLocation = Shader::uniformLocation(packet.program, "octNormals");
+    }
+    state.setInt(objectsLocation, static_cast<GLint>(ObjectBuffer::TEXTURE_UNIT));
+    state.setInt(octNormalsLocation, meshes.front().octNormals ? 1 : 0);
+
+    if (packet.item & STATIC_DRAWS) {
+        staticDraws.submit(packet.program, drawPath, state, packet.item & ~STATIC_DRAWS);
+    } else {
+        size_t i = packet.item & ~OUTGOING_LOD;
+        bool outgoing = (packet.item & OUTGOING_LOD) != 0;
+        meshes[i].Draw(packet.program, state, objectSlot(meshes[i]), outgoing ? lodSelector.previous(i) : lodSelector.level(i),
+                       lodSelector.fade(i, outgoing));
+    }
+}
+
+void Model::setMeshVisible(size_t mesh, bool isVisible) {
+    if (visible.size() < meshes.size())
+        visible.resize(meshes.size(), true);
+    if (visible[mesh] != isVisible) {
+        visible[mesh] = isVisible;
+        drawListDirty = true;
+    }
+}
+
+int Model::findNode(const std::string& name) const {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].name == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void Model::setNodeTransform(int node, const glm::mat4& local) {
+    nodes[node].local = local;
+    nodesDirty = true;
+}
+
+// Los padres van antes que los hijos: una sola pasada en orden
+void Model::updateNodes() {
+    for (auto& node : nodes)
+        node.world = node.parent < 0 ? node.local : nodes[node.parent].world * node.local;
+    nodesDirty = false;
+    bvhDirty = true;
+}
+
+// Con las mallas que pasaron el frustum: descarta las que el último resultado
+// vio tapadas y pide las consultas de este frame. Las cajas que cruzan el plano
+// near no se pueden consultar (la cámara está adentro o casi): se dibujan.
+void Model::cullOccluded(const CullView& culling, const glm::mat4& modelMatrix) {
+    const float NEAR_MARGIN = 0.05f;
+    ObjectBuffer& objects = ObjectBuffer::instance();
+    CullView modelView = culling.toObject(modelMatrix);
+
+    occlusion.collect();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (!meshVisibility.test(i)) {
+            occlusion.reset(i);
+            continue;
+        }
+        const Mesh& mesh = meshes[i];
+        float nearDistance = mesh.node < 0 ? modelView.nearDistance(mesh.bounds)
+                                           : culling.toObject(objects.model(objectSlot(mesh))).nearDistance(mesh.bounds);
+        if (nearDistance < NEAR_MARGIN) {
+            occlusion.reset(i);
+            continue;
+        }
+        if (occlusion.update(i, mesh.bounds, objectSlot(mesh))) {
+            meshVisibility.set(i, false);
+            lastCull.occluded++;
+        }
+    }
+}
+
+void Model::addOccluders(SoftwareOcclusion& buffer, const glm::mat4& modelMatrix) {
+    if (meshVisibility.size() != meshes.size())
+        return;
+    if (nodesDirty)
+        updateNodes();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        if (mesh.occluder.empty() || (i < visible.size() && !visible[i]))
+            continue;
+        buffer.addOccluder(mesh.node < 0 ? modelMatrix : modelMatrix * nodes[mesh.node].world, mesh.bounds, mesh.occluder);
+    }
+}
+
+// Con las mallas que pasaron el frustum: las que quedan enteras detrás de los
+// oclusores de este frame no se envían (tampoco piden consulta de oclusión)
+void Model::cullSoftwareOccluded(const SoftwareOcclusion& buffer) {
+    ObjectBuffer& objects = ObjectBuffer::instance();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (!meshVisibility.test(i))
+            continue;
+        const Mesh& mesh = meshes[i];
+        if (buffer.occluded(objects.model(objectSlot(mesh)), mesh.bounds)) {
+            meshVisibility.set(i, false);
+            lastCull.softwareOccluded++;
+        }
+    }
+}
+
+// Nivel de detalle de cada malla que se va a dibujar, según cuántos píxeles
+// ocuparía su error a la distancia de su caja. Sin vista de detalle solo se
+// usan los niveles que no pierden nada (error 0).
+void Model::selectLods(const CullView* detail, const glm::mat4& modelMatrix, bool culled) {
+    const float NEAR_MARGIN = 0.05f;
+    ObjectBuffer& objects = ObjectBuffer::instance();
+    if (lodSelector.size() != meshes.size())
+        lodSelector.resize(meshes.size());
+    lodSelector.beginFrame(std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    CullView modelView = detail ? detail->toObject(modelMatrix) : CullView();
+
+    lastLod = LodStats();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        if ((i < visible.size() && !visible[i]) || (culled && !meshVisibility.test(i))) {
+            lodSelector.skip(i);
+            continue;
+        }
+
+        // Con la cámara encima de la caja, cualquier error se ve
+        float pixelsPerUnit = std::numeric_limits<float>::max();
+        if (detail && mesh.lods.size() > 1) {
+            CullView view = mesh.node < 0 ? modelView : detail->toObject(objects.model(objectSlot(mesh)));
+            float distance = view.nearDistance(mesh.bounds);
+            if (distance > NEAR_MARGIN)
+                pixelsPerUnit = view.pixelScale * view.objectScale / distance;
+        }
+        lodSelector.update(i, mesh.lods, pixelsPerUnit, lodBias, lodCrossfade);
+
+        uint32_t level = lodSelector.level(i);
+        lastLod.meshes[level]++;
+        lastLod.triangles[level] += mesh.lods[level].indexCount / 3;
+        lastLod.fullTriangles += mesh.lods.front().indexCount / 3;
+        if (lodSelector.fading(i)) {
+            uint32_t previous = lodSelector.previous(i);
+            lastLod.triangles[previous] += mesh.lods[previous].indexCount / 3;
+            lastLod.fading++;
+        }
+    }
+}
+
+// Los clusters lejanos cuya esfera ocupa a lo sumo impostorPixels de diámetro
+// se dibujan como impostor: sus mallas salen de meshVisibility (sin culling,
+// se parte de todas visibles). Devuelve si reemplazó alguno.
+bool Model::selectImpostors(const CullView* detail, bool culled, const glm::mat4& modelMatrix) {
+    const float NEAR_MARGIN = 0.05f;
+    impostors.clear();
+    lastImpostors = ImpostorStats();
+    if (!useImpostors || !detail || !impostors.ready())
+        return false;
+    lastImpostors.clusters = clusters.size();
+
+    CullView view = detail->toObject(modelMatrix);
+    bool replaced = false;
+    for (size_t c = 0; c < clusters.size(); c++) {
+        const ImpostorCluster& cluster = clusters[c];
+        float distance = view.nearDistance(cluster.bounds);
+        float diameter = 2.0f * cluster.bounds.radius() * view.objectScale;
+        if (distance <= NEAR_MARGIN || diameter * view.pixelScale > impostorPixels * distance)
+            continue;
+        if (!culled && !replaced)
+            meshVisibility.resize(meshes.size(), true);
+        replaced = true;
+        for (uint32_t mesh : cluster.meshes)
+            meshVisibility.set(mesh, false);
+        if (view.intersects(cluster.bounds)) {
+            impostors.add(cluster, c);
+            lastImpostors.drawn++;
+            lastImpostors.triangles += cluster.triangles;
+        }
+    }
+    return replaced;
+}
+
+// Refit si solo se movieron nodos; se reconstruye la primera vez y cuando el
+// árbol quedó demasiado peor que recién construido
+void Model::updateBvh() {
+    modelSpaceBounds.resize(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        modelSpaceBounds[i] = mesh.node < 0 ? mesh.bounds : mesh.bounds.transformed(nodes[mesh.node].world);
+    }
+    if (bvh.size() != meshes.size()) {
+        bvh.build(modelSpaceBounds);
+    } else {
+        bvh.refit(modelSpaceBounds);
+        if (bvh.needsRebuild())
+            bvh.build(modelSpaceBounds);
+    }
+    bvhDirty = false;
+}
+namespace {
+    // Flags de importación; forman parte de la clave de la caché de mallas.
+    // El espacio tangente solo se calcula si el layout lo lleva a la GPU.
+    // El orden de triángulos y vértices lo decide MeshOptimizer (sin ImproveCacheLocality).
+    unsigned int importFlags(VertexFormat format) {
+        unsigned int flags =
+            aiProcess_Triangulate |
+            aiProcess_FlipUVs |
+            aiProcess_GenSmoothNormals |
+            aiProcess_JoinIdenticalVertices |
+            aiProcess_RemoveRedundantMaterials |
+            aiProcess_FindInvalidData |
+            aiProcess_OptimizeMeshes;
+        if (needsTangents(format))
+            flags |= aiProcess_CalcTangentSpace;
+        return flags;
+    }
+
+    // Reenvía el avance de Assimp (lectura + postprocesado) a la barra de carga
+    class ImportProgress : public Assimp::ProgressHandler {
+    public:
+        explicit ImportProgress(std::atomic<float>* target) : target(target) {}
+
+        bool Update(float percentage) override {
+            if (target && percentage >= 0.0f)
+                target->store(0.9f * percentage);
+            return true;
+        }
+
+    private:
+        std::atomic<float>* target;
+    };
+
+    // Caja, triángulos y orientación de las mallas que se hornean en el espacio
+    // del modelo (fuera de los nodos animados), para elegir las celdas
+    void measureStatic(const aiNode* node, const aiScene* scene, const glm::mat4& parentTransform,
+                       const std::unordered_set<std::string>& animatedNodes, MeshBounds& bounds, size_t& triangles,
+                       glm::vec3& facing) {
+        if (animatedNodes.count(node->mName.C_Str()))
+            return;
+        glm::mat4 transform = parentTransform * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+        float winding = glm::determinant(glm::mat3(transform)) < 0.0f ? -1.0f : 1.0f;
+
+        std::vector<glm::vec3> positions;
+        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+            const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+            positions.resize(mesh->mNumVertices);
+            for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+                const aiVector3D& p = mesh->mVertices[v];
+                positions[v] = glm::vec3(transform * glm::vec4(p.x, p.y, p.z, 1.0f));
+                bounds.min = glm::min(bounds.min, positions[v]);
+                bounds.max = glm::max(bounds.max, positions[v]);
+            }
+            for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+                const aiFace& face = mesh->mFaces[f];
+                if (face.mNumIndices != 3)
+                    continue;
+                const glm::vec3& a = positions[face.mIndices[0]];
+                facing += winding * glm::cross(positions[face.mIndices[1]] - a, positions[face.mIndices[2]] - a);
+                triangles++;
+            }
+        }
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+            measureStatic(node->mChildren[i], scene, transform, animatedNodes, bounds, triangles, facing);
+    }
+}
+
+size_t ModelSource::meshCount() const {
+    return fromCache ? cached.size() : imported.size();
+}
+
+void Model::loadModel(const std::string& path, VertexFormat format) {
+    ModelSource source;
+    if (!import(path, format, source))
+        return;
+
+    // Decodificar en paralelo todas las texturas que usa el modelo antes de crear las mallas
+    TextureCache::instance().prefetch(source.texturePaths);
+    upload(source, std::numeric_limits<double>::infinity());
 }
-void Model::loadModel(const std::string& path) {
+
+bool Model::import(const std::string& path, VertexFormat format, ModelSource& source, std::atomic<float>* progress) {
+    source.path = path;
+    source.directory = path.substr(0, path.find_last_of('/'));
+    source.format = format;
+    unsigned int flags = importFlags(format);
+
+    // Arranque en caliente: subir directamente desde la caché proyectada, sin Assimp
+    ScopedTimer cacheTimer("MeshCache", path);
+    bool cached = source.cache.open(path, flags, format);
+    cacheTimer.stop();
+    if (cached) {
+        source.fromCache = true;
+        source.nodes = source.cache.nodes();
+        for (uint32_t i = 0; i < source.cache.meshCount(); i++) {
+            source.cached.push_back(source.cache.mesh(i));
+            for (const auto& tex : source.cached.back().textures)
+                source.texturePaths.push_back(source.directory + "/" + tex.path);
+        }
+        if (progress)
+            progress->store(1.0f);
+
+        source.up = source.cache.up();
+        std::cout << "MeshCache: " << path << " cargado desde caché (" << source.cached.size() << " mallas)" << std::endl;
+        source.valid = true;
+        return true;
+    }
+
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
-        aiProcess_Triangulate |
-        aiProcess_FlipUVs |
-        aiProcess_CalcTangentSpace |
-        aiProcess_GenSmoothNormals |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_ImproveCacheLocality |
-        aiProcess_RemoveRedundantMaterials |
-        aiProcess_FindInvalidData |
-        aiProcess_OptimizeMeshes);
+    ImportProgress handler(progress);
+    importer.SetProgressHandler(&handler);
+    ScopedTimer importTimer("Assimp", path);
+    const aiScene* scene = importer.ReadFile(path, flags);
+    importTimer.stop();
 
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
-        return;
+        importer.SetProgressHandler(nullptr);
+        return false;
     }
 
-    directory = path.substr(0, path.find_last_of('/'));
+    // Los nodos con canales de animación conservan su transformación; el resto se hornea
+    std::unordered_set<std::string> animatedNodes;
+    for (unsigned int i = 0; i < scene->mNumAnimations; i++) {
+        const aiAnimation* animation = scene->mAnimations[i];
+        for (unsigned int j = 0; j < animation->mNumChannels; j++)
+            animatedNodes.insert(animation->mChannels[j]->mNodeName.C_Str());
+    }
 
-    // ✅ Llama a processNode con matriz identidad como transformación raíz
-    processNode(scene->mRootNode, scene, glm::mat4(1.0f));
+    // Los modelos grandes se parten en celdas (ver ClusterGrid)
+    MeshBounds staticExtent;
+    staticExtent.min = glm::vec3(std::numeric_limits<float>::max());
+    staticExtent.max = glm::vec3(-std::numeric_limits<float>::max());
+    size_t staticTriangles = 0;
+    glm::vec3 facing(0.0f);
+    measureStatic(scene->mRootNode, scene, glm::mat4(1.0f), animatedNodes, staticExtent, staticTriangles, facing);
+    ClusterGrid grid = ClusterGrid::fit(staticExtent, staticTriangles, facing);
+    if (grid.valid())
+        source.up = grid.up();
+
+    processNode(scene->mRootNode, scene, glm::mat4(1.0f), -1, animatedNodes, format, grid.valid() ? &grid : nullptr, source);
+    importer.SetProgressHandler(nullptr);
+
+    if (grid.valid()) {
+        std::vector<bool> usedCells(ClusterGrid::CELLS * ClusterGrid::CELLS, false);
+        for (const auto& data : source.imported) {
+            if (data.cluster >= 0)
+                usedCells[data.cluster] = true;
+        }
+        std::cout << "ClusterGrid: " << path << ": " << std::count(usedCells.begin(), usedCells.end(), true)
+                  << " celdas, " << source.imported.size() << " mallas después de partir" << std::endl;
+    }
+
+    MeshOptimizeReport report;
+    for (const auto& data : source.imported)
+        report.add(data.optimization);
+    std::cout << "MeshOptimizer: " << path << ": " << report.triangles << " triángulos, ACMR "
+              << report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+              << report.before.atvr << " -> " << report.after.atvr << std::endl;
+
+    size_t lodTriangles[MeshSimplifier::MAX_LODS] = {};
+    size_t meshesWithLods = 0;
+    for (const auto& data : source.imported) {
+        for (size_t level = 0; level < data.lods.size(); level++)
+            lodTriangles[level] += data.lods[level].indexCount / 3;
+        meshesWithLods += data.lods.size() > 1;
+    }
+    std::cout << "MeshSimplifier: " << path << ": " << meshesWithLods << " de " << source.imported.size()
+              << " mallas con niveles, triángulos " << lodTriangles[0] << "/" << lodTriangles[1] << "/"
+              << lodTriangles[2] << "/" << lodTriangles[3] << std::endl;
+
+    std::cout << "Modelo " << path << ": " << source.nodes.size() << " nodos dinámicos" << std::endl;
+    MeshCache::write(path, flags, format, source.imported, source.nodes, source.up);
+
+    for (const auto& data : source.imported) {
+        for (const auto& tex : data.textures)
+            source.texturePaths.push_back(source.directory + "/" + tex.path);
+    }
+    if (progress)
+        progress->store(1.0f);
+
+    source.valid = true;
+    return true;
 }
 
+bool Model::upload(ModelSource& source, double budgetMs) {
+    directory = source.directory;
+    format = source.format;
+    if (meshes.empty()) {
+        nodes = source.nodes;
+        updateNodes();
+    }
+    if (objectCount == 0) {
+        objectCount = nodes.size() + 1;
+        objectBase = ObjectBuffer::instance().allocate(objectCount);
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    if (meshes.empty())
+        reserveGeometry(source);
+
+    while (meshes.size() < source.meshCount()) {
+        size_t i = meshes.size();
+        if (source.fromCache) {
+            const CachedMesh& mesh = source.cached[i];
+            meshes.emplace_back(format, mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount, mesh.indexType,
+                                loadTextures(mesh.textures), mesh.quantization);
+            meshes.back().node = mesh.node;
+            meshes.back().bounds = mesh.bounds;
+            meshes.back().features = mesh.features;
+            meshes.back().occluder.assign(mesh.occluder, mesh.occluder + size_t(mesh.occluderTriangles) * 3);
+            if (mesh.lodCount > 0)
+                meshes.back().lods.assign(mesh.lods, mesh.lods + mesh.lodCount);
+            meshes.back().cluster = mesh.cluster;
+        } else {
+            const MeshData& data = source.imported[i];
+            meshes.emplace_back(format, data.vertices.data(), data.vertexCount, data.indices.data(), data.indexCount,
+                                data.indexType, loadTextures(data.textures), data.quantization);
+            meshes.back().node = data.node;
+            meshes.back().bounds = data.bounds;
+            meshes.back().features = data.features;
+            meshes.back().occluder = data.occluder;
+            if (!data.lods.empty())
+                meshes.back().lods = data.lods;
+            meshes.back().cluster = data.cluster;
+        }
+
+        if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+            break;
+    }
+
+    drawListDirty = true;
+    if (meshes.size() < source.meshCount())
+        return false;
+
+    // Claves de la cola: material = VAO de la arena + arreglos de textura
+    GLuint vertexArray = GeometryArena::instance(format).vertexArray();
+    staticMaterial = RenderQueue::materialId({ vertexArray });
+    cullVolumes.clear();
+    cullVolumes.reserve(meshes.size());
+    cullRanges.clear();
+    meshVisibility.resize(meshes.size(), true);
+    bvhDirty = true;
+    occlusion.resize(meshes.size());
+    lodSelector.resize(meshes.size());
+    bool firstStatic = true;
+    for (auto& mesh : meshes) {
+        std::vector<GLuint> bindings{ vertexArray };
+        for (const auto& tex : mesh.textures)
+            bindings.push_back(tex.array);
+        mesh.material = RenderQueue::materialId(bindings);
+        mesh.features = shaderVariantFor(mesh.features, needsTangents(format));
+
+        if (cullRanges.empty() || cullRanges.back().node != mesh.node)
+            cullRanges.push_back(CullRange{ mesh.node, cullVolumes.size(), 0 });
+        cullRanges.back().count++;
+        cullVolumes.add(mesh.bounds.min, mesh.bounds.max);
+
+        if (mesh.node < 0) {
+            if (firstStatic)
+                staticBounds = mesh.bounds;
+            else
+                staticBounds.merge(mesh.bounds);
+            firstStatic = false;
+        }
+    }
 
+    // Clusters de impostores: las mallas estáticas de cada celda de ClusterGrid
+    clusters.clear();
+    std::vector<int> clusterIndex(ClusterGrid::CELLS * ClusterGrid::CELLS, -1);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        if (mesh.cluster < 0 || mesh.node >= 0)
+            continue;
+        int& index = clusterIndex[mesh.cluster];
+        if (index < 0) {
+            index = static_cast<int>(clusters.size());
+            clusters.push_back(ImpostorCluster{ mesh.bounds, {}, 0 });
+        }
+        ImpostorCluster& cluster = clusters[index];
+        cluster.bounds.merge(mesh.bounds);
+        cluster.meshes.push_back(static_cast<uint32_t>(i));
+        cluster.triangles += mesh.lods.front().indexCount / 3;
+    }
+    if (!clusters.empty())
+        impostors.build(source.path, meshes, clusters, objectBase, vertexArray, source.up);
 
+    printVertexStats(source);
+    printTextureStats();
+    return true;
+}
+
+void Model::reserveGeometry(const ModelSource& source) {
+    size_t vertexCount = 0;
+    size_t indexBytes = 0;
+    for (size_t i = 0; i < source.meshCount(); i++) {
+        size_t count = source.fromCache ? source.cached[i].indexCount : source.imported[i].indexCount;
+        GLenum type = source.fromCache ? source.cached[i].indexType : source.imported[i].indexType;
+        vertexCount += source.fromCache ? source.cached[i].vertexCount : source.imported[i].vertexCount;
+        indexBytes += (count * indexSize(type) + 3) / 4 * 4;
+    }
+    GeometryArena::instance(source.format).reserve(vertexCount, indexBytes);
+}
+
+void Model::printVertexStats(const ModelSource& source) {
+    size_t vertexCount = 0;
+    size_t shortIndexMeshes = 0;
+    float maxError = 0.0f;
+    for (size_t i = 0; i < source.meshCount(); i++) {
+        vertexCount += source.fromCache ? source.cached[i].vertexCount : source.imported[i].vertexCount;
+        GLenum indexType = source.fromCache ? source.cached[i].indexType : source.imported[i].indexType;
+        if (indexType == GL_UNSIGNED_SHORT)
+            shortIndexMeshes++;
+        if (isQuantized(source.format)) {
+            // Medio paso de unorm16 en el eje más largo de la caja
+            const VertexQuantization& q = source.fromCache ? source.cached[i].quantization : source.imported[i].quantization;
+            float extent = std::max({ q.scale.x, q.scale.y, q.scale.z });
+            maxError = std::max(maxError, extent / 65535.0f * 0.5f);
+        }
+    }
 
-void Model::processNode(aiNode* node, const aiScene* scene, glm::mat4 parentTransform)
+    vertexBytes = vertexCount * vertexStride(source.format);
+    std::cout << "Modelo " << source.path << ": " << vertexCount << " vértices, "
+              << vertexBytes / 1024 << " KB en la GPU (" << vertexStride(source.format) << " bytes por vértice";
+    if (isQuantized(source.format))
+        std::cout << ", cuantizados, error máx. de posición " << maxError;
+    std::cout << "), índices de 16 bits en " << shortIndexMeshes << "/" << source.meshCount() << " mallas" << std::endl;
+}
+
+void Model::printTextureStats() const {
+    const TextureCacheStats& stats = TextureCache::instance().stats();
+    std::cout << "TextureCache: " << stats.misses << " cargadas, "
+              << stats.pathHits << " aciertos por ruta, "
+              << stats.contentHits << " aciertos por contenido, "
+              << stats.failures << " fallos, " << stats.bakedLoads << " horneadas, ~"
+              << stats.vramBytes / (1024 * 1024) << " MB de VRAM en " << stats.arrays << " arreglos" << std::endl;
+}
+
+
+
+
+// Recorrido en preorden: cada nodo dinámico se agrega después de su padre.
+// parentTransform es la transformación acumulada desde parentNode (o desde la raíz)
+// y se hornea en los vértices de los nodos estáticos.
+void Model::processNode(aiNode* node, const aiScene* scene, glm::mat4 parentTransform, int parentNode,
+                        const std::unordered_set<std::string>& animatedNodes, VertexFormat format, const ClusterGrid* grid,
+                        ModelSource& source)
 {
-    // 🔹 1. Obtener la transformación local del nodo
     glm::mat4 localTransform = glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+    glm::mat4 transform = parentTransform * localTransform;
+
+    if (animatedNodes.count(node->mName.C_Str())) {
+        ModelNode dynamicNode;
+        dynamicNode.name = node->mName.C_Str();
+        dynamicNode.parent = parentNode;
+        dynamicNode.local = transform;
+        parentNode = static_cast<int>(source.nodes.size());
+        source.nodes.push_back(dynamicNode);
+        transform = glm::mat4(1.0f);
+    }
 
-    // 🔹 2. Combinar con la transformación acumulada (del padre)
-    glm::mat4 globalTransform = parentTransform * localTransform;
-
-    // 🔹 3. Procesar todas las mallas del nodo
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene)); // ← aquí podrías pasar globalTransform más adelante si haces skinning
+        size_t first = source.imported.size();
+        processMesh(mesh, scene, transform, format, parentNode < 0 ? grid : nullptr, source.imported);
+        for (size_t k = first; k < source.imported.size(); k++)
+            source.imported[k].node = parentNode;
     }
 
-    // 🔹 4. Recursivamente procesar los nodos hijos
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene, globalTransform);
+        processNode(node->mChildren[i], scene, transform, parentNode, animatedNodes, format, grid, source);
     }
 }
 
 
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
-    std::vector<Vertex> vertices;
+void Model::processMesh(aiMesh* mesh, const aiScene* scene, const glm::mat4& transform, VertexFormat format,
+                        const ClusterGrid* grid, std::vector<MeshData>& out) {
+    ScopedTimer timer("Malla", mesh->mName.length ? mesh->mName.C_Str() : "(sin nombre)");
+
+    std::vector<Vertex> fullVertices;
     std::vector<GLuint> indices;
     std::vector<Texture> textures;
 
+    fullVertices.reserve(mesh->mNumVertices);
+    indices.reserve(size_t(mesh->mNumFaces) * 3);
+
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
         Vertex vertex;
         vertex.Position = glm::vec3(
@@ -111,8 +763,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
             vertex.Bitangent = glm::vec3(0.0f);
         }
 
-
-        vertices.push_back(vertex);
+        fullVertices.push_back(vertex);
     }
 
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
@@ -120,6 +771,32 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         for (unsigned int j = 0; j < face.mNumIndices; j++)
             indices.push_back(face.mIndices[j]);
     }
+
+    // Hornear la transformación del nodo (la identidad en los nodos dinámicos)
+    if (transform != glm::mat4(1.0f)) {
+        glm::mat3 linear(transform);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        auto direction = [](const glm::mat3& m, const glm::vec3& v) {
+            glm::vec3 d = m * v;
+            float length = glm::length(d);
+            return length > 0.0f ? d / length : d;
+        };
+        for (auto& vertex : fullVertices) {
+            vertex.Position = glm::vec3(transform * glm::vec4(vertex.Position, 1.0f));
+            vertex.Normal = direction(normalMatrix, vertex.Normal);
+            vertex.Tangent = direction(linear, vertex.Tangent);
+            vertex.Bitangent = direction(linear, vertex.Bitangent);
+        }
+
+        // Una escala negativa invierte el sentido de los triángulos
+        if (glm::determinant(linear) < 0.0f) {
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+                std::swap(indices[i + 1], indices[i + 2]);
+        }
+    }
+
+    uint32_t features = 0;
+    bool opaque = true;
     if (mesh->mMaterialIndex >= 0) {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
@@ -152,11 +829,92 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         for (const auto& tex : emissiveMaps)
             std::cout << "Malla usa emissive: " << tex.path << std::endl;
         textures.insert(textures.end(), emissiveMaps.begin(), emissiveMaps.end());
-    }
 
+        // Lo que pide el material; la variante final depende además del formato de vértice
+        int shadingModel = 0;
+        if (material->Get(AI_MATKEY_SHADING_MODEL, shadingModel) == AI_SUCCESS && shadingModel == aiShadingMode_Unlit)
+            features |= MaterialFeature::Unlit;
+        if (!normalMaps.empty())
+            features |= MaterialFeature::NormalMap;
+        if (!metallicMaps.empty())
+            features |= MaterialFeature::Specular;
+        if (!emissiveMaps.empty())
+            features |= MaterialFeature::Emissive;
+
+        // Lo transparente o recortado por alfa no tapa lo que tiene atrás
+        aiString alphaMode;
+        float opacity = 1.0f;
+        if (material->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode) == AI_SUCCESS && alphaMode != aiString("OPAQUE"))
+            opaque = false;
+        if (material->Get(AI_MATKEY_OPACITY, opacity) == AI_SUCCESS && opacity < 1.0f)
+            opaque = false;
+    }
 
+    // Estática en un modelo partido en celdas: una malla por celda que toca
+    if (grid) {
+        for (ClusterGrid::Piece& piece : grid->split(fullVertices, indices)) {
+            out.push_back(finishMesh(piece.vertices, piece.indices, textures, features, opaque, format));
+            out.back().cluster = piece.cell;
+        }
+    } else {
+        out.push_back(finishMesh(fullVertices, indices, textures, features, opaque, format));
+    }
+}
 
-    return Mesh(vertices, indices, textures);
+// Optimiza, simplifica y empaqueta los vértices e índices ya en el espacio final
+MeshData Model::finishMesh(std::vector<Vertex>& fullVertices, std::vector<GLuint>& indices, const std::vector<Texture>& textures,
+                           uint32_t features, bool opaque, VertexFormat format) {
+    // Caché de vértices, overdraw y orden de lectura; quita los vértices sin usar
+    MeshOptimizeReport optimization = MeshOptimizer::optimize(fullVertices, indices);
+
+    // Niveles de detalle: sus índices van detrás de los del nivel 0, sobre los mismos vértices
+    std::vector<MeshLod> lods = MeshSimplifier::buildLods(fullVertices, indices);
+
+    // AABB de la malla: orden por distancia y, si el formato está cuantizado,
+    // las posiciones son relativas a ella
+    MeshBounds bounds;
+    if (!fullVertices.empty()) {
+        bounds.min = glm::vec3(std::numeric_limits<float>::max());
+        bounds.max = glm::vec3(-std::numeric_limits<float>::max());
+        for (const auto& vertex : fullVertices) {
+            bounds.min = glm::min(bounds.min, vertex.Position);
+            bounds.max = glm::max(bounds.max, vertex.Position);
+        }
+    }
+    VertexQuantization quantization;
+    if (isQuantized(format) && !fullVertices.empty())
+        quantization = VertexQuantization::fromBounds(bounds.min, bounds.max);
+
+    // Solo se empaquetan los atributos del layout elegido
+    std::vector<unsigned char> vertices(fullVertices.size() * vertexStride(format));
+    withVertexLayout(format, [&](auto layout) {
+        using Layout = decltype(layout);
+        for (size_t i = 0; i < fullVertices.size(); i++)
+            Layout::pack(fullVertices[i], quantization, vertices.data() + i * Layout::stride);
+    });
+
+    GLenum indexType = indexTypeFor(fullVertices.size());
+    std::vector<unsigned char> packedIndices(indices.size() * indexSize(indexType));
+    if (indexType == GL_UNSIGNED_SHORT) {
+        uint16_t* out = reinterpret_cast<uint16_t*>(packedIndices.data());
+        for (size_t i = 0; i < indices.size(); i++)
+            out[i] = static_cast<uint16_t>(indices[i]);
+    } else {
+        std::memcpy(packedIndices.data(), indices.data(), packedIndices.size());
+    }
+    MeshData data{ std::move(vertices), fullVertices.size(), quantization, std::move(packedIndices), indices.size(), indexType,
+                   textures, features, -1, bounds, optimization, {}, std::move(lods) };
+
+    // Triángulos oclusores para SoftwareOcclusion, en el mismo espacio que los
+    // vértices: solo del nivel 0, los simplificados se salen de la malla
+    if (opaque) {
+        std::vector<glm::vec3> positions(fullVertices.size());
+        for (size_t i = 0; i < fullVertices.size(); i++)
+            positions[i] = fullVertices[i].Position;
+        std::vector<uint32_t> baseIndices(indices.begin(), indices.begin() + data.lods.front().indexCount);
+        data.occluder = SoftwareOcclusion::extractOccluder(positions, baseIndices, bounds);
+    }
+    return data;
 }
 
 std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName) {
@@ -166,46 +924,35 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType
         aiString str;
         mat->GetTexture(type, i, &str);
 
-        std::string filename = directory + "/" + std::string(str.C_Str());
-
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-
-        int width, height, nrComponents;
-        unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-        std::cout << "Cargando textura: " << filename << " (" << (data ? "Éxito" : "FALLÓ") << ")" << std::endl;
+        // Solo se guarda la referencia; la imagen se carga en loadTextures
+        Texture texture;
+        texture.id = 0;
+        texture.type = typeName;
+        texture.path = str.C_Str();
+        textures.push_back(texture);
+    }
 
-        if (data) {
-            GLenum format;
-            if (nrComponents == 1)
-                format = GL_RED;
-            else if (nrComponents == 3)
-                format = GL_RGB;
-            else if (nrComponents == 4)
-                format = GL_RGBA;
+    return textures;
+}
 
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+std::vector<Texture> Model::loadTextures(const std::vector<Texture>& refs) {
+    std::vector<Texture> textures;
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    for (const auto& ref : refs) {
+        std::string filename = directory + "/" + ref.path;
 
-            stbi_image_free(data);
+        // El registro compartido evita decodificar y subir dos veces la misma imagen
+        GLuint textureID = TextureCache::instance().acquire(filename);
+        if (textureID == 0)
+            continue;
 
-            Texture texture;
-            texture.id = textureID;
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-        } else {
-            std::cerr << "Failed to load texture at path: " << filename << std::endl;
-            stbi_image_free(data);
-        }
+        TextureLocation location = TextureCache::instance().location(textureID);
+        Texture texture = ref;
+        texture.id = textureID;
+        texture.array = location.array;
+        texture.layer = location.layer;
+        textures.push_back(texture);
     }
 
     return textures;
 }
-
@@ -2,27 +2,198 @@
 
 #include <glad.h>
 #include <glm.hpp>
+#include <atomic>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
+#include "Bvh.h"
+#include "ClusterGrid.h"
+#include "DrawList.h"
+#include "ImpostorAtlas.h"
+#include "LodSelector.h"
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "OcclusionQueries.h"
+#include "RenderQueue.h"
+#include "ShaderVariants.h"
+#include "SoftwareOcclusion.h"
 
-class Model {
+// Resultado de importar un modelo en CPU; se puede preparar en un hilo de trabajo
+struct ModelSource {
+    std::string path;
+    std::string directory;
+    size_t vertexBytes = 0;
+    VertexFormat format = VertexFormat::Standard;
+    bool valid = false;
+    bool fromCache = false;
+    MeshCache cache;                      // arranque en caliente: mallas proyectadas
+    std::vector<CachedMesh> cached;
+    std::vector<MeshData> imported;       // arranque en frío: salida de Assimp
+    glm::vec3 up = glm::vec3(0.0f);       // ClusterGrid::up; cero si el modelo no se partió en celdas
+    std::vector<ModelNode> nodes;         // nodos dinámicos, de padre a hijo
+    std::vector<std::string> texturePaths;
+
+    size_t meshCount() const;
+};
+
+class Model : public Renderable {
 public:
-    // Constructor que carga el modelo
-    Model(const std::string& path);
+    // Constructor que carga el modelo (las texturas quedan con los mipmaps
+    // pequeños hasta que alguien llame a TextureCache::stream)
+    Model(const std::string& path, VertexFormat format = VertexFormat::Standard);
+    // Modelo vacío que se llena con upload (carga asíncrona)
+    Model();
+    ~Model();
+
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    // Solo CPU (sin OpenGL): caché de mallas o Assimp. Los vértices quedan
+    // empaquetados en format (ver chooseVertexFormat). progress va de 0 a 1
+    static bool import(const std::string& path, VertexFormat format, ModelSource& source, std::atomic<float>* progress = nullptr);
+
+    // Hilo de OpenGL: crea las mallas pendientes hasta agotar el presupuesto (ms).
+    // Las texturas de source deben estar precargadas. Devuelve true al terminar.
+    bool upload(ModelSource& source, double budgetMs);
+
+    // Envía los dibujos del modelo a la cola; modelMatrix ubica el modelo entero.
+    // Escribe las transformaciones en ObjectBuffer, que hay que subir antes de
+    // ejecutar la cola.
+    // Cada malla usa la variante de shaders que cubre su material. Si la cola
+    // trae culling, solo se envían las mallas cuya caja toca el frustum y que
+    // no quedan tapadas. Si trae vista de detalle, cada malla se dibuja en el
+    // nivel de detalle que elige LodSelector. Los clusters lejanos se
+    // reemplazan por su impostor (ver useImpostors).
+    void submit(RenderQueue& queue, ShaderVariants& shaders, const glm::mat4& modelMatrix);
+
+    // Dibuja el modelo ya mismo, con una cola propia
+    void Draw(ShaderVariants& shaders, const glm::mat4& modelMatrix);
+
+    void draw(const RenderPacket& packet, RenderState& state) override;
+
+    // Nodos dinámicos: los animados del glTF. Los estáticos ya están horneados
+    // en los vértices y no se pueden mover por separado.
+    const std::vector<ModelNode>& dynamicNodes() const { return nodes; }
+    int findNode(const std::string& name) const;   // -1 si no es dinámico
+    void setNodeTransform(int node, const glm::mat4& local);
+
+    // Camino de envío para las mallas estáticas de todos los modelos
+    // (MultiDrawIndirect cae a CachedLoop sin GL 4.3)
+    static DrawPath drawPath;
 
-    // Dibuja el modelo
-    void Draw(GLuint shaderProgram);
+    // Culling con el BVH de cada modelo (true) o caja por caja (false)
+    static bool hierarchicalCulling;
+    // Descartar también lo tapado según consultas de oclusión de frames anteriores
+    static bool occlusionCulling;
+    // Descartar lo que tapan los oclusores según SoftwareOcclusion::instance(),
+    // si ya se rasterizó en este frame (ver addOccluders)
+    static bool softwareOcclusion;
+
+    // Niveles de detalle generados al importar (false = siempre el nivel 0)
+    static bool levelOfDetail;
+    // log2 del error en pantalla permitido: positivo = niveles más simples antes
+    static float lodBias;
+    // Transición con tramado entre niveles (variantes LOD_FADE del shader)
+    static bool lodCrossfade;
+
+    // Impostores de los clusters (modelos partidos por ClusterGrid): se
+    // dibujan en lugar de sus mallas cuando la esfera del cluster ocupa a lo
+    // sumo impostorPixels píxeles de diámetro
+    static bool useImpostors;
+    static float impostorPixels;
+
+    // Agrega al buffer de oclusión por software los oclusores de las mallas
+    // (los triángulos grandes que se guardaron al importar). Antes de submit.
+    void addOccluders(SoftwareOcclusion& buffer, const glm::mat4& modelMatrix);
+
+    // Oculta una malla; la lista guardada se rehace solo si cambia algo
+    void setMeshVisible(size_t mesh, bool visible);
+    size_t meshCount() const { return meshes.size(); }
+
+    // Resultado del culling del último submit (en cero si la cola no tenía)
+    const CullStats& cullStats() const { return lastCull; }
+    // Niveles de detalle dibujados en el último submit
+    const LodStats& lodStats() const { return lastLod; }
+    // Impostores dibujados en el último submit
+    const ImpostorStats& impostorStats() const { return lastImpostors; }
+
+    // Comandos y lotes de la última lista de mallas estáticas
+    size_t cachedDrawCount() const { return staticDraws.drawCount(); }
+    size_t cachedBatchCount() const { return staticDraws.batchCount(); }
+
+    // Memoria de los vértices en la GPU (sin índices)
+    size_t gpuVertexBytes() const { return vertexBytes; }
 
 private:
     std::vector<Mesh> meshes;
     std::string directory;
+    VertexFormat format = VertexFormat::Standard;
+    size_t vertexBytes = 0;
+    std::vector<ModelNode> nodes;
+    bool nodesDirty = false;
+    std::vector<bool> visible;        // vacío = todas visibles
+    DrawList staticDraws;
+    bool drawListDirty = true;
+    MeshBounds staticBounds;          // de todas las mallas sin nodo dinámico
+    uint32_t staticMaterial = 0;
+
+    // Culling: las cajas de las mallas en el orden de meshes, en tramos
+    // consecutivos que comparten transformación (el modelo o un nodo dinámico)
+    struct CullRange {
+        int node;
+        size_t first;
+        size_t count;
+    };
+    BoundsSoA cullVolumes;
+    std::vector<CullRange> cullRanges;
+    VisibilityBits meshVisibility;
+    CullStats lastCull;
+    // Las mismas cajas en el espacio del modelo (las de nodos dinámicos, movidas
+    // por su nodo) y su jerarquía; se reajusta cuando se mueve un nodo
+    std::vector<MeshBounds> modelSpaceBounds;
+    Bvh bvh;
+    bool bvhDirty = true;
+    OcclusionCuller occlusion;
+    LodSelector lodSelector;
+    LodStats lastLod;
+    // Mallas de cada celda de ClusterGrid y sus impostores
+    std::vector<ImpostorCluster> clusters;
+    ImpostorAtlas impostors;
+    ImpostorStats lastImpostors;
+
+    uint32_t objectBase = 0;             // ranuras en ObjectBuffer: el modelo y luego cada nodo
+    size_t objectCount = 0;
+    GLuint uniformProgram = 0;           // programa de las ubicaciones de abajo
+    GLint objectsLocation = -1;
+    GLint octNormalsLocation = -1;
+
+    uint32_t objectSlot(const Mesh& mesh) const { return objectBase + static_cast<uint32_t>(mesh.node + 1); }
+
+    static const uint32_t STATIC_DRAWS = 0x80000000u;   // RenderPacket::item: bit de la lista guardada + grupo
+    static const uint32_t OUTGOING_LOD = 0x40000000u;   // RenderPacket::item: bit del nivel que sale + malla
+    static const uint32_t IMPOSTORS = 0x20000000u;      // RenderPacket::item: los impostores del frame
 
-    void loadModel(const std::string& path);
-    void processNode(aiNode* node, const aiScene* scene, glm::mat4 parentTransform);
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-    std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName);
+    void loadModel(const std::string& path, VertexFormat format);
+    static void processNode(aiNode* node, const aiScene* scene, glm::mat4 parentTransform, int parentNode,
+                            const std::unordered_set<std::string>& animatedNodes, VertexFormat format, const ClusterGrid* grid,
+                            ModelSource& source);
+    static void processMesh(aiMesh* mesh, const aiScene* scene, const glm::mat4& transform, VertexFormat format,
+                            const ClusterGrid* grid, std::vector<MeshData>& out);
+    static MeshData finishMesh(std::vector<Vertex>& fullVertices, std::vector<GLuint>& indices, const std::vector<Texture>& textures,
+                               uint32_t features, bool opaque, VertexFormat format);
+    void updateNodes();
+    void updateBvh();
+    void cullOccluded(const CullView& culling, const glm::mat4& modelMatrix);
+    void cullSoftwareOccluded(const SoftwareOcclusion& buffer);
+    void selectLods(const CullView* detail, const glm::mat4& modelMatrix, bool culled);
+    bool selectImpostors(const CullView* detail, bool culled, const glm::mat4& modelMatrix);
+    static std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName);
+    std::vector<Texture> loadTextures(const std::vector<Texture>& refs);
+    static void reserveGeometry(const ModelSource& source);
+    void printVertexStats(const ModelSource& source);
+    void printTextureStats() const;
 };
@@ -0,0 +1,63 @@
+#include "ObjectBuffer.h"
+
+#include <algorithm>
+
+ObjectBuffer& ObjectBuffer::instance() {
+    // Sin destructor: el búfer vive hasta que se destruye el contexto
+    static ObjectBuffer* buffer = new ObjectBuffer();
+    return *buffer;
+}
+
+uint32_t ObjectBuffer::allocate(size_t count) {
+    size_t first = 0;
+    while (!slots.allocate(count, first))
+        slots.grow(std::max<size_t>(slots.capacity() * 2, slots.capacity() + count));
+    if (models.size() < slots.capacity())
+        models.resize(slots.capacity(), glm::mat4(1.0f));
+    return static_cast<uint32_t>(first);
+}
+
+void ObjectBuffer::release(uint32_t first, size_t count) {
+    slots.release(first, count);
+}
+
+void ObjectBuffer::upload() {
+    size_t count = models.size();
+    if (count == 0)
+        return;
+    objects.resize(count);
+
+    // Inversa traspuesta por cofactores: tres productos cruz y un determinante,
+    // sin ramas, sobre arreglos contiguos
+    const glm::mat4* in = models.data();
+    ObjectData* out = objects.data();
+    for (size_t i = 0; i < count; i++) {
+        const glm::mat4& m = in[i];
+        glm::vec3 c0(m[0]), c1(m[1]), c2(m[2]);
+        glm::vec3 r0 = glm::cross(c1, c2);
+        glm::vec3 r1 = glm::cross(c2, c0);
+        glm::vec3 r2 = glm::cross(c0, c1);
+        float det = glm::dot(c0, r0);
+        float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+
+        out[i].model = m;
+        out[i].normal[0] = glm::vec4(r0 * invDet, 0.0f);
+        out[i].normal[1] = glm::vec4(r1 * invDet, 0.0f);
+        out[i].normal[2] = glm::vec4(r2 * invDet, 0.0f);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Almacenamiento nuevo cada frame: el driver no espera a que terminen los dibujos del anterior
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, count * sizeof(ObjectData), objects.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+#include "GeometryArena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Datos por objeto tal como los lee model.vert: 7 texels RGBA32F.
+// La matriz normal es la inversa traspuesta de la parte 3x3 de model, calculada
+// en CPU una vez por objeto en lugar de una vez por vértice.
+struct ObjectData {
+    glm::mat4 model;
+    glm::vec4 normal[3];   // columnas; w sin usar
+};
+static_assert(sizeof(ObjectData) == 7 * 16, "ObjectData debe ocupar 7 texels RGBA32F");
+
+// Transformaciones de todos los objetos dibujables (un modelo entero o un nodo
+// dinámico) en un texture buffer. Cada objeto tiene una ranura fija mientras
+// vive; el shader la recibe por dibujo (DrawAttrib::Object) y lee sus datos con
+// texelFetch. Solo desde el hilo de OpenGL.
+class ObjectBuffer {
+public:
+    // Unidad de textura reservada para el samplerBuffer "objects"
+    static const GLuint TEXTURE_UNIT = 15;
+
+    static ObjectBuffer& instance();
+
+    // count ranuras consecutivas; devuelve la primera
+    uint32_t allocate(size_t count);
+    void release(uint32_t first, size_t count);
+
+    void setModel(uint32_t slot, const glm::mat4& model) { models[slot] = model; }
+    const glm::mat4& model(uint32_t slot) const { return models[slot]; }
+
+    // Una vez por frame, antes de dibujar: calcula las matrices normales de
+    // todas las ranuras, sube el búfer y lo deja ligado en TEXTURE_UNIT
+    void upload();
+
+    size_t objectCount() const { return slots.used(); }
+
+    ObjectBuffer(const ObjectBuffer&) = delete;
+    ObjectBuffer& operator=(const ObjectBuffer&) = delete;
+
+private:
+    ObjectBuffer() = default;
+
+    RangeAllocator slots;
+    std::vector<glm::mat4> models;     // lo que escriben los modelos
+    std::vector<ObjectData> objects;   // lo que se sube
+    GLuint buffer = 0;
+    GLuint texture = 0;
+};
@@ -0,0 +1,118 @@
+#include "OcclusionQueries.h"
+#include "FrameUniforms.h"
+#include "ObjectBuffer.h"
+#include "Shader.h"
+
+namespace {
+    // Agranda las cajas para que las caras de una malla que coinciden con su
+    // propia caja no la tapen (z-fighting con GL_LEQUAL)
+    const float BOX_MARGIN = 0.01f;
+}
+
+OcclusionQueries& OcclusionQueries::instance() {
+    // Sin destructor: el programa y el VAO viven hasta que se destruye el contexto
+    static OcclusionQueries* queries = new OcclusionQueries();
+    return *queries;
+}
+
+GLenum OcclusionQueries::target() {
+    return GLAD_GL_VERSION_4_3 ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+}
+
+void OcclusionQueries::request(GLuint query, const MeshBounds& box, uint32_t object) {
+    MeshBounds inflated = box;
+    glm::vec3 margin = (box.max - box.min) * BOX_MARGIN + glm::vec3(BOX_MARGIN);
+    inflated.min -= margin;
+    inflated.max += margin;
+    requests.push_back(Request{ query, inflated, object });
+}
+
+void OcclusionQueries::flush() {
+    frameNumber++;
+    issued = requests.size();
+    if (requests.empty())
+        return;
+
+    if (!shader) {
+        shader.reset(new Shader("Shaders/occlusion.vert", "Shaders/occlusion.frag"));
+        FrameUniforms::attach(*shader);
+        shader->Use();
+        shader->setInt("objects", static_cast<int>(ObjectBuffer::TEXTURE_UNIT));
+        objectLocation = shader->location("object");
+        boxMinLocation = shader->location("boxMin");
+        boxMaxLocation = shader->location("boxMax");
+        glGenVertexArrays(1, &vertexArray);
+    }
+
+    // Solo profundidad de lectura: la caja no deja rastro en el frame
+    shader->Use();
+    glBindVertexArray(vertexArray);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+
+    GLenum queryTarget = target();
+    for (const Request& request : requests) {
+        glUniform1i(objectLocation, static_cast<GLint>(request.object));
+        glUniform3fv(boxMinLocation, 1, &request.box.min[0]);
+        glUniform3fv(boxMaxLocation, 1, &request.box.max[0]);
+        glBeginQuery(queryTarget, request.query);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glEndQuery(queryTarget);
+    }
+
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glBindVertexArray(0);
+    requests.clear();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    for (const State& state : states) {
+        if (state.query != 0)
+            glDeleteQueries(1, &state.query);
+    }
+}
+
+void OcclusionCuller::resize(size_t count) {
+    states.resize(count);
+}
+
+void OcclusionCuller::collect() {
+    for (State& state : states) {
+        if (!state.pending)
+            continue;
+        GLuint available = 0;
+        glGetQueryObjectuiv(state.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint samples = 0;
+        glGetQueryObjectuiv(state.query, GL_QUERY_RESULT, &samples);
+        state.pending = false;
+        if (!state.stale)
+            state.occluded = samples == 0;
+        state.stale = false;
+    }
+}
+
+bool OcclusionCuller::update(size_t i, const MeshBounds& box, uint32_t object) {
+    State& state = states[i];
+    // Los visibles se reparten entre los frames del intervalo según su índice
+    uint32_t frame = OcclusionQueries::instance().frame();
+    bool due = state.occluded || (frame + static_cast<uint32_t>(i) * 7u) % VISIBLE_INTERVAL == 0;
+    if (!state.pending && due) {
+        if (state.query == 0)
+            glGenQueries(1, &state.query);
+        OcclusionQueries::instance().request(state.query, box, object);
+        state.pending = true;
+    }
+    return state.occluded;
+}
+
+void OcclusionCuller::reset(size_t i) {
+    State& state = states[i];
+    state.occluded = false;
+    if (state.pending)
+        state.stale = true;
+}
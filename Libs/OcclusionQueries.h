@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+#include "Culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Shader;
+
+// Consultas de oclusión de cajas, juntadas en una sola pasada por frame.
+// Los dueños piden consultas con request mientras envían sus dibujos y flush
+// las dibuja todas después de la cola, contra la profundidad de los opacos,
+// sin escribir color ni profundidad. Los resultados se leen frames después,
+// cuando están listos (OcclusionCuller): nunca se espera a la GPU.
+// Solo desde el hilo de OpenGL.
+class OcclusionQueries {
+public:
+    static OcclusionQueries& instance();
+
+    // GL_ANY_SAMPLES_PASSED_CONSERVATIVE en GL 4.3; si no, GL_ANY_SAMPLES_PASSED (3.3)
+    static GLenum target();
+
+    // Frames completos (flush cuenta uno)
+    uint32_t frame() const { return frameNumber; }
+
+    // box en el espacio de la ranura object de ObjectBuffer
+    void request(GLuint query, const MeshBounds& box, uint32_t object);
+
+    // Después de ObjectBuffer::upload y de ejecutar la cola
+    void flush();
+
+    // Consultas emitidas en el último flush
+    size_t lastIssued() const { return issued; }
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+private:
+    OcclusionQueries() = default;
+
+    struct Request {
+        GLuint query;
+        MeshBounds box;
+        uint32_t object;
+    };
+
+    std::vector<Request> requests;
+    std::unique_ptr<Shader> shader;
+    GLuint vertexArray = 0;   // vacío: los vértices salen de gl_VertexID
+    GLint objectLocation = -1, boxMinLocation = -1, boxMaxLocation = -1;
+    uint32_t frameNumber = 0;
+    size_t issued = 0;
+};
+
+// Visibilidad por oclusión de un conjunto de elementos (las mallas de un
+// modelo), con coherencia temporal al estilo de CHC++: cada elemento conserva
+// el último resultado hasta que llega uno nuevo. Los ocultos se consultan
+// todos los frames; los visibles, cada VISIBLE_INTERVAL frames (repartidos)
+// para notar cuando algo los tapa.
+class OcclusionCuller {
+public:
+    static const uint32_t VISIBLE_INTERVAL = 8;
+
+    OcclusionCuller() = default;
+    ~OcclusionCuller();
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    void resize(size_t count);
+
+    // Lee los resultados que ya llegaron, sin esperar
+    void collect();
+
+    bool occluded(size_t i) const { return states[i].occluded; }
+
+    // El elemento está en el frustum: pide su consulta si le toca.
+    // Devuelve si hay que descartarlo por oclusión.
+    bool update(size_t i, const MeshBounds& box, uint32_t object);
+
+    // Fuera del frustum o demasiado cerca de la cámara para consultar su caja:
+    // cuando vuelva se lo supone visible
+    void reset(size_t i);
+
+private:
+    struct State {
+        GLuint query = 0;
+        bool pending = false;    // consulta en vuelo
+        bool stale = false;      // su resultado ya no sirve (reset mientras estaba en vuelo)
+        bool occluded = false;
+    };
+
+    std::vector<State> states;
+};
@@ -0,0 +1,261 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <gtc/type_ptr.hpp>
+
+namespace {
+    const int PASS_SHIFT = 62;
+    const int FREE_BITS = 14;
+
+    const GLuint UNKNOWN = ~0u;
+}
+
+uint64_t DrawKey::make(RenderPass pass, uint32_t shader, uint32_t material, uint16_t depth) {
+    uint64_t key = uint64_t(pass) << PASS_SHIFT;
+    uint64_t state = (uint64_t(shader & (MAX_SHADERS - 1)) << 24) | (material & (MAX_MATERIALS - 1));
+    if (pass == RenderPass::Transparent) {
+        uint16_t farFirst = static_cast<uint16_t>(0xFFFF - depth);
+        key |= uint64_t(farFirst) << (FREE_BITS + 32);
+        key |= state << FREE_BITS;
+    } else {
+        key |= state << (FREE_BITS + 16);
+        key |= uint64_t(depth) << FREE_BITS;
+    }
+    return key;
+}
+
+RenderPass DrawKey::pass(uint64_t key) {
+    return static_cast<RenderPass>(key >> PASS_SHIFT);
+}
+
+void RenderState::reset() {
+    currentProgram = UNKNOWN;
+    currentVertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    textures.clear();
+    uniforms.clear();
+}
+
+void RenderState::useProgram(GLuint program) {
+    if (program == currentProgram) {
+        stats.programSkips++;
+        return;
+    }
+    glUseProgram(program);
+    currentProgram = program;
+    stats.programBinds++;
+}
+
+void RenderState::bindVertexArray(GLuint vertexArray) {
+    if (vertexArray == currentVertexArray) {
+        stats.vertexArraySkips++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    currentVertexArray = vertexArray;
+    stats.vertexArrayBinds++;
+}
+
+void RenderState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    auto bound = std::find_if(textures.begin(), textures.end(), [&](const BoundTexture& b) {
+        return b.unit == unit && b.target == target;
+    });
+    if (bound != textures.end() && bound->texture == texture) {
+        stats.textureSkips++;
+        return;
+    }
+    if (bound == textures.end())
+        textures.push_back(BoundTexture{ unit, target, texture });
+    else
+        bound->texture = texture;
+
+    if (activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    glBindTexture(target, texture);
+    stats.textureBinds++;
+}
+
+RenderState::UniformValue* RenderState::findUniform(GLint location) {
+    for (auto& uniform : uniforms) {
+        if (uniform.program == currentProgram && uniform.location == location)
+            return &uniform;
+    }
+    return nullptr;
+}
+
+void RenderState::setInt(GLint location, GLint value) {
+    if (location < 0)
+        return;
+    UniformValue* uniform = findUniform(location);
+    if (uniform && uniform->value[0][0] == static_cast<float>(value)) {
+        stats.uniformSkips++;
+        return;
+    }
+    if (!uniform) {
+        uniforms.push_back(UniformValue{ currentProgram, location, glm::mat4(0.0f) });
+        uniform = &uniforms.back();
+    }
+    uniform->value[0][0] = static_cast<float>(value);
+    glUniform1i(location, value);
+    stats.uniformSets++;
+}
+
+void RenderState::setMat4(GLint location, const glm::mat4& value) {
+    if (location < 0)
+        return;
+    UniformValue* uniform = findUniform(location);
+    if (uniform && std::memcmp(&uniform->value, &value, sizeof(glm::mat4)) == 0) {
+        stats.uniformSkips++;
+        return;
+    }
+    if (!uniform) {
+        uniforms.push_back(UniformValue{ currentProgram, location, value });
+        uniform = &uniforms.back();
+    }
+    uniform->value = value;
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    stats.uniformSets++;
+}
+
+void RenderQueue::begin(const glm::vec3& cameraPosition, float farPlane, const CullView* culling) {
+    camera = cameraPosition;
+    hasCulling = culling != nullptr;
+    if (culling)
+        cullView = *culling;
+    hasDetail = false;
+    this->farPlane = farPlane > 0.0f ? farPlane : 1.0f;
+    packets.clear();
+    entries.clear();
+}
+
+void RenderQueue::setDetailView(const CullView& view) {
+    detail = view;
+    hasDetail = true;
+}
+
+uint16_t RenderQueue::depthBucket(const glm::vec3& worldCenter) const {
+    float distance = glm::length(worldCenter - camera) / farPlane;
+    return static_cast<uint16_t>(std::clamp(distance, 0.0f, 1.0f) * 65535.0f);
+}
+
+void RenderQueue::submit(RenderPass pass, uint32_t material, const glm::vec3& worldCenter, const RenderPacket& packet) {
+    uint64_t key = DrawKey::make(pass, shaderId(packet.program), material, depthBucket(worldCenter));
+    entries.push_back(SortEntry{ key, static_cast<uint32_t>(packets.size()) });
+    packets.push_back(packet);
+}
+
+// LSD de a 8 bits, estable; se saltan los bytes en los que todas las claves coinciden
+// (los bits libres y, casi siempre, la pasada y el shader)
+void RenderQueue::sortEntries() {
+    if (entries.size() < 2)
+        return;
+    scratch.resize(entries.size());
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (const SortEntry& entry : entries)
+            counts[(entry.key >> shift) & 0xFF]++;
+        if (counts[(entries.front().key >> shift) & 0xFF] == entries.size())
+            continue;
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t n = count;
+            count = offset;
+            offset += n;
+        }
+        for (const SortEntry& entry : entries)
+            scratch[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        entries.swap(scratch);
+    }
+}
+
+void RenderQueue::enterPass(RenderPass pass) {
+    switch (pass) {
+    case RenderPass::Opaque:
+        break;
+    case RenderPass::Background:
+        glDepthFunc(GL_LEQUAL);   // el skybox queda en z = 1 (ver skybox.vert)
+        break;
+    case RenderPass::Transparent:
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+        break;
+    }
+}
+
+void RenderQueue::leavePass(RenderPass pass) {
+    switch (pass) {
+    case RenderPass::Opaque:
+        break;
+    case RenderPass::Background:
+        glDepthFunc(GL_LESS);
+        break;
+    case RenderPass::Transparent:
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+        break;
+    }
+}
+
+void RenderQueue::execute() {
+    lastStats = RenderStats();
+    lastStats.packets = packets.size();
+    if (packets.empty())
+        return;
+
+    sortEntries();
+
+    RenderState state(lastStats);
+    state.reset();
+    bool inPass = false;
+    RenderPass currentPass = RenderPass::Opaque;
+
+    for (const SortEntry& entry : entries) {
+        RenderPass pass = DrawKey::pass(entry.key);
+        if (!inPass || pass != currentPass) {
+            if (inPass)
+                leavePass(currentPass);
+            enterPass(pass);
+            currentPass = pass;
+            inPass = true;
+        }
+
+        const RenderPacket& packet = packets[entry.packet];
+        state.useProgram(packet.program);
+        state.bindVertexArray(packet.vertexArray);
+        packet.owner->draw(packet, state);
+    }
+    leavePass(currentPass);
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    packets.clear();
+    entries.clear();
+}
+
+uint32_t RenderQueue::shaderId(GLuint program) {
+    static std::map<GLuint, uint32_t> ids;
+    auto it = ids.find(program);
+    if (it != ids.end())
+        return it->second;
+    // Más shaders que bits: comparten el último valor (solo se pierde agrupamiento)
+    uint32_t id = std::min(static_cast<uint32_t>(ids.size()), DrawKey::MAX_SHADERS - 1);
+    ids[program] = id;
+    return id;
+}
+
+uint32_t RenderQueue::materialId(const std::vector<GLuint>& bindings) {
+    static std::map<std::vector<GLuint>, uint32_t> ids;
+    auto it = ids.find(bindings);
+    if (it != ids.end())
+        return it->second;
+    uint32_t id = std::min(static_cast<uint32_t>(ids.size()), DrawKey::MAX_MATERIALS - 1);
+    ids[bindings] = id;
+    return id;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+#include "Culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pasadas en el orden en que se dibujan
+enum class RenderPass : uint8_t {
+    Opaque = 0,        // de adelante hacia atrás, para que el early-z descarte lo tapado
+    Background = 1,    // skybox: después de los opacos, solo donde quedó el fondo (GL_LEQUAL)
+    Transparent = 2    // de atrás hacia adelante, con blending y sin escribir profundidad
+};
+
+// Clave de orden de 64 bits (de más a menos significativo):
+//   opacos y fondo: pasada 2 | shader 8 | material 24 | profundidad 16 | libres 14
+//   transparentes:  pasada 2 | profundidad invertida 16 | shader 8 | material 24 | libres 14
+// Con los opacos, primero se agrupa por estado y luego por distancia; con los
+// transparentes manda la distancia para que el blending sea correcto.
+namespace DrawKey {
+    constexpr uint32_t MAX_SHADERS = 1u << 8;
+    constexpr uint32_t MAX_MATERIALS = 1u << 24;
+
+    uint64_t make(RenderPass pass, uint32_t shader, uint32_t material, uint16_t depth);
+    RenderPass pass(uint64_t key);
+}
+
+// Cambios de estado pedidos durante un RenderQueue::execute: los emitidos y
+// los que se evitaron porque el valor ya estaba puesto
+struct RenderStats {
+    size_t packets = 0;
+    size_t drawCalls = 0;
+    size_t programBinds = 0, programSkips = 0;
+    size_t vertexArrayBinds = 0, vertexArraySkips = 0;
+    size_t textureBinds = 0, textureSkips = 0;
+    size_t uniformSets = 0, uniformSkips = 0;
+
+    size_t issued() const { return programBinds + vertexArrayBinds + textureBinds + uniformSets; }
+    size_t saved() const { return programSkips + vertexArraySkips + textureSkips + uniformSkips; }
+};
+
+// Estado de OpenGL conocido durante la ejecución de la cola. Cada función
+// compara con lo último que se puso y no llama a GL si no cambia.
+class RenderState {
+public:
+    explicit RenderState(RenderStats& stats) : stats(stats) {}
+
+    // Olvida todo: el próximo pedido de cada cosa llega a GL
+    void reset();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    // Uniforms del programa actual; location < 0 no hace nada
+    void setInt(GLint location, GLint value);
+    void setMat4(GLint location, const glm::mat4& value);
+
+    GLuint program() const { return currentProgram; }
+
+    // Para quien dibuja por su cuenta (un glDraw* emitido)
+    void countDraw(size_t draws = 1) { stats.drawCalls += draws; }
+
+private:
+    struct BoundTexture {
+        GLuint unit;
+        GLenum target;
+        GLuint texture;
+    };
+
+    struct UniformValue {
+        GLuint program;
+        GLint location;
+        glm::mat4 value;     // los enteros van en [0][0]
+    };
+
+    UniformValue* findUniform(GLint location);
+
+    RenderStats& stats;
+    GLuint currentProgram = 0;
+    GLuint currentVertexArray = 0;
+    GLuint activeUnit = 0;
+    std::vector<BoundTexture> textures;
+    std::vector<UniformValue> uniforms;
+};
+
+class Renderable;
+
+// Un dibujo en la cola. owner sabe qué es item (una malla, una lista guardada...)
+// y debe seguir vivo hasta execute.
+struct RenderPacket {
+    Renderable* owner = nullptr;
+    uint32_t item = 0;
+    GLuint program = 0;        // la cola lo liga antes de llamar a draw
+    GLuint vertexArray = 0;    // ídem
+};
+
+// Lo que se puede poner en la cola: Model, Skybox, ...
+class Renderable {
+public:
+    virtual ~Renderable() = default;
+
+    // Con el programa y el VAO del paquete ya ligados
+    virtual void draw(const RenderPacket& packet, RenderState& state) = 0;
+};
+
+// Cola de dibujos de un frame. Los renderables envían paquetes con submit en
+// cualquier orden; execute los ordena por clave (radix sort) y los dibuja
+// saltando los cambios de estado repetidos. Solo desde el hilo de OpenGL.
+class RenderQueue {
+public:
+    // Empieza un frame: la profundidad de cada paquete es su distancia a la
+    // cámara, cuantizada en [0, farPlane]. Con culling, los renderables
+    // descartan lo que queda fuera de esa vista antes de enviarlo.
+    void begin(const glm::vec3& cameraPosition, float farPlane, const CullView* culling = nullptr);
+
+    // nullptr si este frame no hace culling
+    const CullView* culling() const { return hasCulling ? &cullView : nullptr; }
+
+    // Vista con la que se eligen los niveles de detalle, aunque no haya culling.
+    // Se borra en begin; nullptr = todo en el nivel 0.
+    void setDetailView(const CullView& view);
+    const CullView* detailView() const { return hasDetail ? &detail : nullptr; }
+
+    // worldCenter: punto del paquete en el mundo para ordenar por distancia
+    void submit(RenderPass pass, uint32_t material, const glm::vec3& worldCenter, const RenderPacket& packet);
+
+    // Ordena, dibuja y vacía la cola. Deja el VAO 0 y la unidad de textura 0 activos.
+    void execute();
+
+    // Identificadores pequeños y estables para la clave. Un material es el
+    // conjunto de objetos de GL que liga un paquete (VAO, arreglos de textura...)
+    static uint32_t shaderId(GLuint program);
+    static uint32_t materialId(const std::vector<GLuint>& bindings);
+
+    size_t size() const { return packets.size(); }
+
+    // Contadores del último execute
+    const RenderStats& stats() const { return lastStats; }
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    uint16_t depthBucket(const glm::vec3& worldCenter) const;
+    void sortEntries();
+    static void enterPass(RenderPass pass);
+    static void leavePass(RenderPass pass);
+
+    glm::vec3 camera = glm::vec3(0.0f);
+    float farPlane = 1.0f;
+    CullView cullView;
+    bool hasCulling = false;
+    CullView detail;
+    bool hasDetail = false;
+    std::vector<RenderPacket> packets;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    RenderStats lastStats;
+};
@@ -1,13 +1,37 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "ShaderCache.h"
+
+// FNV-1a de 32 bits sobre el nombre de un uniform o bloque
+constexpr uint32_t uniformHash(std::string_view name)
+{
+    uint32_t h = 0x811C9DC5u;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+// Nombre de un uniform ya reducido a su hash. Desde un literal se calcula al
+// compilar: shader.setInt("skybox", 0) no recorre el texto en tiempo de ejecución.
+struct UniformId
+{
+    uint32_t hash;
+
+    consteval UniformId(const char* name) : hash(uniformHash(name)) {}
+    explicit constexpr UniformId(uint32_t hash) : hash(hash) {}
+};
 
 class Shader
 {
@@ -15,75 +39,18 @@ public:
     // Nota: Es GLuint, no unsigned int como en otros ejemplos. Ambas son válidas.
     GLuint Program;
 
-    // Constructor que compila los shaders
-    Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+    // Constructor que compila los shaders (o carga el programa de la caché, ver ShaderCache).
+    // defines: variantes del mismo texto, como "NORMAL_MAP"
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const std::vector<std::string>& defines = {})
+        : Shader(ShaderCache::instance().start(vertexPath, fragmentPath, defines))
     {
-        // Leer código fuente de los shaders
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        vShaderFile.exceptions(std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::badbit);
-        try
-        {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            vShaderFile.close();
-            fShaderFile.close();
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ\n";
-        }
-        const GLchar* vShaderCode = vertexCode.c_str();
-        const GLchar* fShaderCode = fragmentCode.c_str();
-
-        GLuint vertex, fragment;
-        GLint success;
-        GLchar infoLog[512];
-
-        // Compilar vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-
-        // Compilar fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-
-        // Enlazar programa
-        this->Program = glCreateProgram();
-        glAttachShader(this->Program, vertex);
-        glAttachShader(this->Program, fragment);
-        glLinkProgram(this->Program);
-        glGetProgramiv(this->Program, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(this->Program, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        }
+    }
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    // Termina un programa ya lanzado: el resto del arranque puede correr mientras el driver compila
+    explicit Shader(ShaderBuild build)
+    {
+        this->Program = ShaderCache::instance().finish(build);
+        reflect(this->Program);
     }
 
     void Use()
@@ -91,21 +58,131 @@ public:
         glUseProgram(this->Program);
     }
 
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat4(UniformId name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(this->Program, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(mat));
     }
 
-    void setInt(const std::string& name, int value) const
+    void setInt(UniformId name, int value) const
     {
-        glUniform1i(glGetUniformLocation(this->Program, name.c_str()), value);
+        glUniform1i(location(name), value);
     }
 
+    GLint location(UniformId name) const
+    {
+        return uniformLocation(this->Program, name);
+    }
 
-    bool hasUniform(const std::string &name) const
+    bool hasUniform(UniformId name) const
     {
+        return location(name) != -1;
+    }
+
+    // Asigna un bloque uniform (std140) a un punto de enlace de GL_UNIFORM_BUFFER
+    bool bindBlock(UniformId block, GLuint binding) const
+    {
+        const Reflection* table = findReflection(this->Program);
+        if (!table)
+            return false;
+        auto it = table->blocks.find(block.hash);
+        if (it == table->blocks.end())
+            return false;
+        glUniformBlockBinding(this->Program, it->second, binding);
+        return true;
+    }
 
-        return glGetUniformLocation(this->Program, name.c_str()) != -1;
+    // Ubicación de un uniform de cualquier programa creado por Shader (-1 si no
+    // está activo). Para quien solo tiene el id del programa, como Model.
+    static GLint uniformLocation(GLuint program, UniformId name)
+    {
+        const Reflection* table = findReflection(program);
+        if (!table)
+            return -1;
+        auto it = table->uniforms.find(name.hash);
+        return it != table->uniforms.end() ? it->second : -1;
+    }
+
+    // Ubicaciones de los atributos de vértice activos (bit i = location i)
+    uint32_t attributeLocations() const
+    {
+        GLint count = 0;
+        glGetProgramiv(this->Program, GL_ACTIVE_ATTRIBUTES, &count);
+
+        uint32_t locations = 0;
+        for (GLint i = 0; i < count; i++) {
+            GLchar name[64];
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(this->Program, i, sizeof(name), &length, &size, &type, name);
+            GLint location = glGetAttribLocation(this->Program, name);
+            if (location >= 0 && location < 32)
+                locations |= 1u << location;
+        }
+        return locations;
+    }
+
+private:
+    // Uniforms y bloques activos de un programa, por hash del nombre
+    struct Reflection {
+        std::unordered_map<uint32_t, GLint> uniforms;
+        std::unordered_map<uint32_t, GLuint> blocks;
+    };
+
+    static std::unordered_map<GLuint, Reflection>& reflection()
+    {
+        static std::unordered_map<GLuint, Reflection> programs;
+        return programs;
+    }
+
+    // nullptr si el programa no lo creó Shader (la búsqueda no agrega entradas)
+    static const Reflection* findReflection(GLuint program)
+    {
+        auto it = reflection().find(program);
+        return it != reflection().end() ? &it->second : nullptr;
+    }
+
+    // Una sola vez al enlazar: después nadie llama a glGetUniformLocation
+    static void reflect(GLuint program)
+    {
+        // El driver puede reusar el id de un programa borrado: nada de su tabla sirve
+        Reflection& table = reflection()[program];
+        table = Reflection();
+        std::unordered_map<uint32_t, std::string> names;   // solo para detectar choques
+        auto add = [&](const std::string& name) {
+            uint32_t hash = uniformHash(name);
+            auto [it, inserted] = names.emplace(hash, name);
+            if (!inserted && it->second != name)
+                std::cerr << "Shader: " << name << " y " << it->second << " tienen el mismo hash" << std::endl;
+            return hash;
+        };
+
+        GLint count = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++) {
+            GLchar name[128];
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+            GLint location = glGetUniformLocation(program, name);
+            if (location < 0)
+                continue;   // dentro de un bloque
+
+            // Los arreglos se listan como "nombre[0]"
+            std::string uniformName(name, length);
+            if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+                uniformName.resize(uniformName.size() - 3);
+            table.uniforms[add(uniformName)] = location;
+        }
+
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (GLint i = 0; i < count; i++) {
+            GLchar name[128];
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(program, i, sizeof(name), &length, name);
+            table.blocks[add(std::string(name, length))] = static_cast<GLuint>(i);
+        }
     }
 };
 
@@ -0,0 +1,288 @@
+#include "ShaderCache.h"
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // GL_KHR_parallel_shader_compile (mismos valores que la versión ARB); glad no la carga
+    const GLenum MAX_SHADER_COMPILER_THREADS = 0x91B0;
+    const GLenum COMPLETION_STATUS = 0x91B1;
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+    const char MAGIC[4] = { 'S', 'T', 'P', 'B' };
+
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t format;     // GLenum de glGetProgramBinary
+        uint64_t key;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    bool hasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    std::string glString(GLenum name) {
+        const GLubyte* text = glGetString(name);
+        return text ? reinterpret_cast<const char*>(text) : "";
+    }
+
+    double millisecondsSince(LoadProfiler::Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(LoadProfiler::Clock::now() - start).count();
+    }
+}
+
+ShaderCache& ShaderCache::instance() {
+    static ShaderCache cache;
+    return cache;
+}
+
+ShaderCache::ShaderCache() {
+    driver = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+    GLint formats = 0;
+    if (GLAD_GL_VERSION_4_1)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    programBinary = formats > 0;
+
+    const char* procName = nullptr;
+    if (hasExtension("GL_KHR_parallel_shader_compile"))
+        procName = "glMaxShaderCompilerThreadsKHR";
+    else if (hasExtension("GL_ARB_parallel_shader_compile"))
+        procName = "glMaxShaderCompilerThreadsARB";
+    if (procName) {
+        auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress(procName));
+        if (maxThreads) {
+            maxThreads(0xFFFFFFFFu);   // tantos hilos como quiera el driver
+            parallelCompile = true;
+        }
+    }
+
+    std::cout << "ShaderCache: binarios " << (programBinary ? "sí" : "no")
+              << ", compilación en paralelo " << (parallelCompile ? "sí" : "no") << std::endl;
+}
+
+std::string ShaderCache::readSource(const std::string& path, const std::vector<std::string>& defines) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return "";
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string code = stream.str();
+
+    if (defines.empty())
+        return code;
+
+    // Los #define van después de #version, que tiene que ser la primera línea
+    std::string block;
+    for (const auto& define : defines)
+        block += "#define " + define + "\n";
+    size_t version = code.find("#version");
+    size_t lineEnd = version == std::string::npos ? std::string::npos : code.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return block + code;
+    return code.insert(lineEnd + 1, block);
+}
+
+// FNV-1a de 64 bits (igual que MeshCache)
+uint64_t ShaderCache::buildKey(const std::string& vertexCode, const std::string& fragmentCode) const {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (const std::string* part : { &driver, &vertexCode, &fragmentCode }) {
+        for (char c : *part) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001B3ull;
+        }
+        h ^= 0xFF;   // separador: "ab" + "c" != "a" + "bc"
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+GLuint ShaderCache::compile(GLenum type, const std::string& code) {
+    GLuint shader = glCreateShader(type);
+    const GLchar* source = code.c_str();
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);   // sin consultar el estado: eso esperaría al driver
+    return shader;
+}
+
+ShaderBuild ShaderCache::start(const std::string& vertexPath, const std::string& fragmentPath,
+                               const std::vector<std::string>& defines) {
+    std::string vertexCode = readSource(vertexPath, defines);
+    std::string fragmentCode = readSource(fragmentPath, defines);
+    uint64_t key = buildKey(vertexCode, fragmentCode);
+
+    auto waiting = pending.find(key);
+    if (waiting != pending.end()) {
+        ShaderBuild build = waiting->second;
+        pending.erase(waiting);
+        return build;
+    }
+
+    ShaderBuild build;
+    build.key = key;
+    build.start = LoadProfiler::Clock::now();
+    build.label = vertexPath + " + " + fragmentPath;
+    for (const auto& define : defines)
+        build.label += " " + define;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.stprog", static_cast<unsigned long long>(key));
+    cachePaths[key] = (std::filesystem::path(vertexPath).parent_path() / "cache" / name).string();
+
+    if (programBinary) {
+        build.program = glCreateProgram();
+        if (loadBinary(cachePaths[key], key, build.program)) {
+            build.fromCache = true;
+            return build;
+        }
+        glDeleteProgram(build.program);
+    }
+
+    build.program = glCreateProgram();
+
+    build.vertex = compile(GL_VERTEX_SHADER, vertexCode);
+    build.fragment = compile(GL_FRAGMENT_SHADER, fragmentCode);
+    glAttachShader(build.program, build.vertex);
+    glAttachShader(build.program, build.fragment);
+    if (programBinary)
+        glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(build.program);
+    return build;
+}
+
+void ShaderCache::precompile(const std::string& vertexPath, const std::string& fragmentPath,
+                             const std::vector<std::string>& defines) {
+    ShaderBuild build = start(vertexPath, fragmentPath, defines);
+    pending[build.key] = build;
+}
+
+bool ShaderCache::ready(const ShaderBuild& build) const {
+    if (build.fromCache || !parallelCompile)
+        return true;
+    GLint done = GL_TRUE;
+    glGetProgramiv(build.program, COMPLETION_STATUS, &done);
+    return done == GL_TRUE;
+}
+
+GLuint ShaderCache::finish(ShaderBuild& build) {
+    if (build.fromCache) {
+        double ms = millisecondsSince(build.start);
+        totals.binaries++;
+        totals.binaryMs += ms;
+        LoadProfiler::instance().record("Shader", build.label + " (binario)", build.start, LoadProfiler::Clock::now());
+        return build.program;
+    }
+
+    GLint success;
+    GLchar infoLog[512];
+
+    glGetShaderiv(build.vertex, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(build.vertex, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED " << build.label << "\n" << infoLog << std::endl;
+    }
+    glGetShaderiv(build.fragment, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(build.fragment, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED " << build.label << "\n" << infoLog << std::endl;
+    }
+
+    GLint linked;
+    glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glGetProgramInfoLog(build.program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << build.label << "\n" << infoLog << std::endl;
+    }
+
+    glDetachShader(build.program, build.vertex);
+    glDetachShader(build.program, build.fragment);
+    glDeleteShader(build.vertex);
+    glDeleteShader(build.fragment);
+    build.vertex = build.fragment = 0;
+
+    double ms = millisecondsSince(build.start);
+    totals.compiled++;
+    totals.compileMs += ms;
+    LoadProfiler::instance().record("Shader", build.label + " (compilado)", build.start, LoadProfiler::Clock::now());
+
+    if (linked && programBinary)
+        saveBinary(build);
+    return linked ? build.program : 0;
+}
+
+bool ShaderCache::loadBinary(const std::string& path, uint64_t key, GLuint program) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    BinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.key != key)
+        return false;
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size()))
+        return false;
+
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Mismo driver según la clave pero otro formato interno: se vuelve a compilar
+        totals.rejected++;
+        std::cout << "ShaderCache: binario rechazado por el driver: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShaderCache::saveBinary(const ShaderBuild& build) {
+    GLint length = 0;
+    glGetProgramiv(build.program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    BinaryHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.key = build.key;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(build.program, length, nullptr, &format, binary.data());
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+
+    const std::string& path = cachePaths[build.key];
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // Primero a un temporal: un binario a medio escribir nunca queda con el nombre final
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), binary.size());
+        if (!out)
+            return;
+    }
+    std::filesystem::rename(temp, path, ec);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad.h>
+#include "LoadProfiler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Un programa lanzado con ShaderCache::start: cargado desde su binario o
+// compilándose (quizás en hilos del driver) hasta que alguien llame a finish
+struct ShaderBuild {
+    GLuint program = 0;
+    GLuint vertex = 0;       // 0 si vino de la caché
+    GLuint fragment = 0;
+    uint64_t key = 0;
+    std::string label;       // rutas y defines, para los mensajes
+    LoadProfiler::Clock::time_point start;
+    bool fromCache = false;
+};
+
+// Tiempos de todos los programas terminados
+struct ShaderCacheStats {
+    size_t binaries = 0;      // cargados con glProgramBinary
+    size_t compiled = 0;      // compilados desde el texto
+    size_t rejected = 0;      // binarios que el driver ya no acepta (se recompilan)
+    double binaryMs = 0.0;
+    double compileMs = 0.0;   // desde start hasta finish, incluye lo que corrió en paralelo
+};
+
+// Caché de programas enlazados en disco (glGetProgramBinary, GL 4.1). La clave
+// es un hash del texto de ambos shaders con sus defines y del vendor, renderer
+// y versión del driver, así que cualquier cambio invalida el binario.
+// En frío, start solo lanza la compilación y el enlace; con
+// GL_KHR_parallel_shader_compile el driver los hace en sus hilos y varios
+// programas avanzan a la vez hasta su finish. Solo desde el hilo de OpenGL.
+class ShaderCache {
+public:
+    static ShaderCache& instance();
+
+    // defines: nombres de macros que se agregan después de #version
+    ShaderBuild start(const std::string& vertexPath, const std::string& fragmentPath,
+                      const std::vector<std::string>& defines = {});
+
+    // Lanza ya un programa que se va a pedir más tarde; el próximo start con los
+    // mismos archivos y defines lo toma en lugar de empezar de nuevo
+    void precompile(const std::string& vertexPath, const std::string& fragmentPath,
+                    const std::vector<std::string>& defines = {});
+
+    // true si finish no va a bloquear (siempre true sin compilación en paralelo)
+    bool ready(const ShaderBuild& build) const;
+
+    // Espera el enlace, informa los errores, guarda el binario nuevo y
+    // devuelve el programa (0 si no enlazó)
+    GLuint finish(ShaderBuild& build);
+
+    bool binarySupported() const { return programBinary; }
+    bool parallelSupported() const { return parallelCompile; }
+    const ShaderCacheStats& stats() const { return totals; }
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+private:
+    ShaderCache();
+
+    // Texto del shader con los #define ya insertados
+    static std::string readSource(const std::string& path, const std::vector<std::string>& defines);
+    uint64_t buildKey(const std::string& vertexCode, const std::string& fragmentCode) const;
+    static GLuint compile(GLenum type, const std::string& code);
+    bool loadBinary(const std::string& path, uint64_t key, GLuint program);
+    void saveBinary(const ShaderBuild& build);
+
+    bool programBinary = false;
+    bool parallelCompile = false;
+    std::string driver;                          // vendor + renderer + versión
+    std::map<uint64_t, ShaderBuild> pending;     // lanzados por precompile
+    std::map<uint64_t, std::string> cachePaths;  // clave -> archivo del binario
+    ShaderCacheStats totals;
+};
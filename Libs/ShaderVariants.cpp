@@ -0,0 +1,48 @@
+#include "ShaderVariants.h"
+
+#include <set>
+
+uint32_t shaderVariantFor(uint32_t materialFeatures, bool hasTangents) {
+    uint32_t features = materialFeatures;
+    if (features & MaterialFeature::Unlit)
+        features &= ~(MaterialFeature::NormalMap | MaterialFeature::Specular);
+    if (!hasTangents)
+        features &= ~MaterialFeature::NormalMap;
+    return features;
+}
+
+ShaderVariants::ShaderVariants(std::string vertexPath, std::string fragmentPath, std::function<void(const Shader&)> setup)
+    : vertexPath(std::move(vertexPath)), fragmentPath(std::move(fragmentPath)), setup(std::move(setup))
+{
+}
+
+std::vector<std::string> ShaderVariants::defines(uint32_t features) {
+    static const char* const NAMES[MaterialFeature::Count] = { "NORMAL_MAP", "SPECULAR", "EMISSIVE", "UNLIT", "LOD_FADE" };
+    std::vector<std::string> result;
+    for (uint32_t bit = 0; bit < MaterialFeature::Count; bit++) {
+        if (features & (1u << bit))
+            result.push_back(NAMES[bit]);
+    }
+    return result;
+}
+
+void ShaderVariants::precompileAll(bool hasTangents) {
+    std::set<uint32_t> reachable;
+    for (uint32_t features = 0; features < (1u << MaterialFeature::Count); features++)
+        reachable.insert(shaderVariantFor(features, hasTangents));
+
+    for (uint32_t features : reachable) {
+        if (shaders.count(features) == 0)
+            ShaderCache::instance().precompile(vertexPath, fragmentPath, defines(features));
+    }
+}
+
+const Shader& ShaderVariants::get(uint32_t features) {
+    auto& shader = shaders[features];
+    if (!shader) {
+        shader.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines(features)));
+        if (setup)
+            setup(*shader);
+    }
+    return *shader;
+}
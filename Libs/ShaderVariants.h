@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Shader.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lo que necesita el material de una malla; cada bit es un #define del shader
+namespace MaterialFeature {
+    const uint32_t NormalMap = 1u << 0;   // NORMAL_MAP: texture_normal1 y espacio tangente
+    const uint32_t Specular = 1u << 1;    // SPECULAR: brillo modulado por texture_metallicRoughness1
+    const uint32_t Emissive = 1u << 2;    // EMISSIVE: suma texture_emissive1
+    const uint32_t Unlit = 1u << 3;       // UNLIT: KHR_materials_unlit, solo el color base
+    const uint32_t LodFade = 1u << 4;     // LOD_FADE: tramado entre niveles de detalle; lo agrega Model::submit, no el material
+    const uint32_t Count = 5;
+}
+
+// La variante más barata que cubre el material con los datos que tiene la malla:
+// sin luz no hay brillo ni mapa de normales, y sin tangentes no hay mapa de normales
+uint32_t shaderVariantFor(uint32_t materialFeatures, bool hasTangents);
+
+// Todas las variantes de un par vertex/fragment, compiladas con los #define de
+// sus bits. Se crean a pedido o por adelantado con precompile (ver ShaderCache).
+class ShaderVariants {
+public:
+    // setup corre sobre cada variante nueva (por ejemplo FrameUniforms::attach)
+    ShaderVariants(std::string vertexPath, std::string fragmentPath,
+                   std::function<void(const Shader&)> setup = nullptr);
+
+    static std::vector<std::string> defines(uint32_t features);
+
+    // Lanza todas las variantes a las que puede llegar shaderVariantFor sin esperarlas
+    void precompileAll(bool hasTangents);
+
+    // Sin defines: sus atributos eligen el VertexFormat
+    const Shader& base() { return get(0); }
+    const Shader& get(uint32_t features);
+
+    size_t compiledCount() const { return shaders.size(); }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::function<void(const Shader&)> setup;
+    std::map<uint32_t, std::unique_ptr<Shader>> shaders;
+};
@@ -0,0 +1,470 @@
+#include "SoftwareOcclusion.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+
+// Mismo criterio que Culling.cpp: AVX con SPEEDTITANS_AVX, SSE en cualquier
+// x86-64 y el bucle escalar en el resto
+#if defined(__AVX__)
+#define OCCLUSION_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const uint32_t FULL_TILE = 0xFFFFFFFFu;
+    const float FAR_DEPTH = std::numeric_limits<float>::infinity();
+
+    // Franjas de bloques que rasteriza cada tarea (cada una escribe solo las suyas)
+    const int BAND_ROWS = 8;
+    const int BAND_COUNT = SoftwareOcclusion::TILES_Y / BAND_ROWS;
+
+    // Oclusores más chicos que esto en pantalla no tapan casi nada (píxeles del buffer)
+    const float MIN_OCCLUDER_AREA = 64.0f;
+    // Triángulos oclusores: respecto de la cara más grande de la caja de su malla
+    const float MIN_TRIANGLE_FRACTION = 1.0f / 1024.0f;
+    // Margen de las aristas para que el redondeo no marque píxeles casi cubiertos
+    const double EDGE_EPSILON = 1.0 / 64.0;
+    // Vértices más allá de esto (en píxeles) pierden precisión: el triángulo no se usa
+    const float GUARD_BAND = 65536.0f;
+
+    glm::vec2 toPixels(const glm::vec4& clip) {
+        float half = 0.5f / clip.w;
+        return glm::vec2((clip.x * half + 0.5f) * SoftwareOcclusion::WIDTH, (clip.y * half + 0.5f) * SoftwareOcclusion::HEIGHT);
+    }
+
+    void boxCorners(const glm::mat4& clip, const MeshBounds& box, glm::vec4 (&corners)[8]) {
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            corners[i] = clip * glm::vec4(corner, 1.0f);
+        }
+    }
+
+    // Reparte los índices [0, count) entre el pool compartido y este hilo y
+    // espera a que terminen todos. body(índice, hilo), con hilo < size() + 1.
+    // Las tareas que el pool empieza tarde ya no encuentran trabajo: nunca se
+    // espera a que se desocupe un hilo que está cargando otra cosa.
+    template <typename Body>
+    void parallelFor(int count, const Body& body) {
+        struct Job {
+            std::atomic<int> next{ 0 };
+            std::atomic<int> done{ 0 };
+            std::atomic<int> workers{ 0 };
+        };
+        auto job = std::make_shared<Job>();
+        auto run = [job, count, &body] {
+            int worker = job->workers.fetch_add(1);
+            for (int i = job->next.fetch_add(1); i < count; i = job->next.fetch_add(1)) {
+                body(i, worker);
+                job->done.fetch_add(1, std::memory_order_release);
+            }
+        };
+
+        ThreadPool& pool = ThreadPool::shared();
+        int helpers = std::min(static_cast<int>(pool.size()), count - 1);
+        for (int i = 0; i < helpers; i++)
+            pool.submit(run, -1);
+        run();
+        while (job->done.load(std::memory_order_acquire) < count)
+            std::this_thread::yield();
+    }
+
+    // Bits de los píxeles que cubre el triángulo en el bloque cuyo primer píxel
+    // tiene el centro en (x, y); el bit de (columna, fila) es fila * 8 + columna
+    uint32_t tileCoverage(const float (&a)[3], const float (&b)[3], const float (&c)[3], float x, float y) {
+        float e[3];
+        bool inside = true;
+        for (int k = 0; k < 3; k++) {
+            e[k] = a[k] * x + b[k] * y + c[k];
+            float largest = e[k] + std::max(a[k], 0.0f) * (SoftwareOcclusion::TILE_WIDTH - 1) +
+                            std::max(b[k], 0.0f) * (SoftwareOcclusion::TILE_HEIGHT - 1);
+            if (largest <= 0.0f)
+                return 0;
+            float smallest = e[k] + std::min(a[k], 0.0f) * (SoftwareOcclusion::TILE_WIDTH - 1) +
+                             std::min(b[k], 0.0f) * (SoftwareOcclusion::TILE_HEIGHT - 1);
+            inside = inside && smallest > 0.0f;
+        }
+        if (inside)
+            return FULL_TILE;
+
+        uint32_t mask = 0;
+#if defined(OCCLUSION_AVX)
+        // Una fila de 8 píxeles por instrucción
+        const __m256 columns = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 row[3], step[3];
+        for (int k = 0; k < 3; k++) {
+            row[k] = _mm256_add_ps(_mm256_set1_ps(e[k]), _mm256_mul_ps(_mm256_set1_ps(a[k]), columns));
+            step[k] = _mm256_set1_ps(b[k]);
+        }
+        for (int r = 0; r < SoftwareOcclusion::TILE_HEIGHT; r++) {
+            __m256 covered = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(row[0], zero, _CMP_GT_OQ), _mm256_cmp_ps(row[1], zero, _CMP_GT_OQ)),
+                                           _mm256_cmp_ps(row[2], zero, _CMP_GT_OQ));
+            mask |= static_cast<uint32_t>(_mm256_movemask_ps(covered)) << (r * 8);
+            for (int k = 0; k < 3; k++)
+                row[k] = _mm256_add_ps(row[k], step[k]);
+        }
+#elif defined(OCCLUSION_SSE)
+        // Media fila por instrucción
+        const __m128 columns = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 left[3], right[3], step[3];
+        for (int k = 0; k < 3; k++) {
+            left[k] = _mm_add_ps(_mm_set1_ps(e[k]), _mm_mul_ps(_mm_set1_ps(a[k]), columns));
+            right[k] = _mm_add_ps(left[k], _mm_set1_ps(a[k] * 4.0f));
+            step[k] = _mm_set1_ps(b[k]);
+        }
+        for (int r = 0; r < SoftwareOcclusion::TILE_HEIGHT; r++) {
+            __m128 coveredLeft = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(left[0], zero), _mm_cmpgt_ps(left[1], zero)), _mm_cmpgt_ps(left[2], zero));
+            __m128 coveredRight = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(right[0], zero), _mm_cmpgt_ps(right[1], zero)), _mm_cmpgt_ps(right[2], zero));
+            uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(coveredLeft)) | static_cast<uint32_t>(_mm_movemask_ps(coveredRight)) << 4;
+            mask |= bits << (r * 8);
+            for (int k = 0; k < 3; k++) {
+                left[k] = _mm_add_ps(left[k], step[k]);
+                right[k] = _mm_add_ps(right[k], step[k]);
+            }
+        }
+#else
+        for (int r = 0; r < SoftwareOcclusion::TILE_HEIGHT; r++) {
+            for (int col = 0; col < SoftwareOcclusion::TILE_WIDTH; col++) {
+                bool covered = true;
+                for (int k = 0; k < 3; k++)
+                    covered = covered && e[k] + a[k] * col + b[k] * r > 0.0f;
+                if (covered)
+                    mask |= 1u << (r * 8 + col);
+            }
+        }
+#endif
+        return mask;
+    }
+}
+
+SoftwareOcclusion& SoftwareOcclusion::instance() {
+    static SoftwareOcclusion* occlusion = new SoftwareOcclusion();
+    return *occlusion;
+}
+
+SoftwareOcclusion::SoftwareOcclusion()
+    : masks(TILES_X * TILES_Y, 0), zMax0(TILES_X * TILES_Y, FAR_DEPTH), zMax1(TILES_X * TILES_Y, 0.0f), rowFarthest(TILES_Y, FAR_DEPTH) {
+}
+
+std::vector<glm::vec3> SoftwareOcclusion::extractOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                                                          const MeshBounds& bounds) {
+    glm::vec3 size = bounds.max - bounds.min;
+    float minArea = std::max({ size.x * size.y, size.y * size.z, size.z * size.x }) * MIN_TRIANGLE_FRACTION;
+    if (minArea <= 0.0f)
+        return {};
+
+    struct Candidate {
+        float area;
+        size_t first;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& p0 = positions[indices[i]];
+        float area = 0.5f * glm::length(glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0));
+        if (area >= minArea)
+            candidates.push_back(Candidate{ area, i });
+    }
+    size_t kept = std::min(candidates.size(), MAX_OCCLUDER_TRIANGLES);
+    std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(),
+                      [](const Candidate& x, const Candidate& y) { return x.area > y.area; });
+
+    std::vector<glm::vec3> triangles;
+    triangles.reserve(kept * 3);
+    for (size_t i = 0; i < kept; i++) {
+        for (size_t k = 0; k < 3; k++)
+            triangles.push_back(positions[indices[candidates[i].first + k]]);
+    }
+    return triangles;
+}
+
+void SoftwareOcclusion::begin(const glm::mat4& viewProjection) {
+    viewProj = viewProjection;
+    draws.clear();
+    triangles.clear();
+    rendered = false;
+}
+
+void SoftwareOcclusion::addOccluder(const glm::mat4& model, const MeshBounds& bounds, const std::vector<glm::vec3>& occluder) {
+    if (occluder.empty())
+        return;
+
+    glm::mat4 clip = viewProj * model;
+    glm::vec4 corners[8];
+    boxCorners(clip, bounds, corners);
+
+    // Fuera del frustum si todas las esquinas quedan del mismo lado de un plano
+    uint32_t outsideAll = 0x3F;
+    bool crossesNear = false;
+    glm::vec2 low(std::numeric_limits<float>::max()), high(-std::numeric_limits<float>::max());
+    for (const glm::vec4& p : corners) {
+        uint32_t outside = (p.x < -p.w) | (p.x > p.w) << 1 | (p.y < -p.w) << 2 | (p.y > p.w) << 3 | (p.z < -p.w) << 4 | (p.z > p.w) << 5;
+        outsideAll &= outside;
+        if (p.z < -p.w) {
+            crossesNear = true;
+            continue;
+        }
+        glm::vec2 pixel = toPixels(p);
+        low = glm::min(low, pixel);
+        high = glm::max(high, pixel);
+    }
+    if (outsideAll != 0)
+        return;
+    // Lo que cruza el plano near está pegado a la cámara: siempre vale la pena
+    if (!crossesNear) {
+        glm::vec2 extent = glm::clamp(high, glm::vec2(0.0f), glm::vec2(WIDTH, HEIGHT)) - glm::clamp(low, glm::vec2(0.0f), glm::vec2(WIDTH, HEIGHT));
+        if (extent.x * extent.y < MIN_OCCLUDER_AREA)
+            return;
+    }
+    draws.push_back(OccluderDraw{ clip, occluder.data(), occluder.size() / 3 });
+}
+
+void SoftwareOcclusion::projectOccluder(const OccluderDraw& draw, std::vector<ScreenTriangle>& out) const {
+    for (size_t t = 0; t < draw.triangleCount; t++) {
+        glm::vec4 clip[3];
+        int inFront = 0;
+        uint32_t outsideAll = 0xF;
+        for (int k = 0; k < 3; k++) {
+            const glm::vec4& p = clip[k] = draw.clip * glm::vec4(draw.vertices[t * 3 + k], 1.0f);
+            inFront += p.z >= -p.w;
+            outsideAll &= (p.x < -p.w) | (p.x > p.w) << 1 | (p.y < -p.w) << 2 | (p.y > p.w) << 3;
+        }
+        // Entero a un costado de la pantalla: ni hace falta proyectarlo
+        if (outsideAll != 0)
+            continue;
+        if (inFront == 3)
+            setupTriangle(clip[0], clip[1], clip[2], out);
+        else if (inFront > 0)
+            clipNear(clip, out);
+    }
+}
+
+// Sutherland-Hodgman contra z = -w: queda un triángulo o un cuadrilátero
+void SoftwareOcclusion::clipNear(const glm::vec4 (&clip)[3], std::vector<ScreenTriangle>& out) {
+    glm::vec4 polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& current = clip[i];
+        const glm::vec4& next = clip[(i + 1) % 3];
+        float dCurrent = current.z + current.w;
+        float dNext = next.z + next.w;
+        if (dCurrent >= 0.0f)
+            polygon[count++] = current;
+        if ((dCurrent >= 0.0f) != (dNext >= 0.0f))
+            polygon[count++] = current + (next - current) * (dCurrent / (dCurrent - dNext));
+    }
+    for (int k = 1; k + 1 < count; k++)
+        setupTriangle(polygon[0], polygon[k], polygon[k + 1], out);
+}
+
+void SoftwareOcclusion::setupTriangle(const glm::vec4& p0, const glm::vec4& p1, const glm::vec4& p2, std::vector<ScreenTriangle>& out) {
+    if (p0.w <= 0.0f || p1.w <= 0.0f || p2.w <= 0.0f)
+        return;
+    glm::vec2 v[3] = { toPixels(p0), toPixels(p1), toPixels(p2) };
+    for (const glm::vec2& p : v) {
+        if (std::abs(p.x) > GUARD_BAND || std::abs(p.y) > GUARD_BAND)
+            return;
+    }
+
+    // Píxeles que puede cubrir enteros: los que tienen el centro a medio píxel del borde de la caja
+    glm::vec2 low = glm::min(v[0], glm::min(v[1], v[2]));
+    glm::vec2 high = glm::max(v[0], glm::max(v[1], v[2]));
+    int x0 = std::max(0, static_cast<int>(std::ceil(low.x)));
+    int y0 = std::max(0, static_cast<int>(std::ceil(low.y)));
+    int x1 = std::min(WIDTH - 1, static_cast<int>(std::floor(high.x)) - 1);
+    int y1 = std::min(HEIGHT - 1, static_cast<int>(std::floor(high.y)) - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    // Sin culling de caras traseras (la ciudad se dibuja sin GL_CULL_FACE):
+    // se ordenan los vértices para que el adentro sea positivo
+    double area = (double(v[1].x) - v[0].x) * (double(v[2].y) - v[0].y) - (double(v[2].x) - v[0].x) * (double(v[1].y) - v[0].y);
+    if (area == 0.0)
+        return;
+    if (area < 0.0)
+        std::swap(v[1], v[2]);
+
+    ScreenTriangle triangle;
+    for (int k = 0; k < 3; k++) {
+        const glm::vec2& from = v[k];
+        const glm::vec2& to = v[(k + 1) % 3];
+        double a = double(from.y) - to.y;
+        double b = double(to.x) - from.x;
+        double c = -(a * from.x + b * from.y);
+        // En píxeles, y corrida hacia adentro lo que hace falta para cubrir el píxel entero
+        double scale = 1.0 / std::max(std::abs(a), std::abs(b));
+        a *= scale;
+        b *= scale;
+        c = c * scale - 0.5 * (std::abs(a) + std::abs(b)) - EDGE_EPSILON;
+        triangle.a[k] = static_cast<float>(a);
+        triangle.b[k] = static_cast<float>(b);
+        triangle.c[k] = static_cast<float>(c);
+    }
+    triangle.zMax = std::max({ p0.w, p1.w, p2.w });
+    triangle.tileX0 = x0 / TILE_WIDTH;
+    triangle.tileY0 = y0 / TILE_HEIGHT;
+    triangle.tileX1 = x1 / TILE_WIDTH;
+    triangle.tileY1 = y1 / TILE_HEIGHT;
+    out.push_back(triangle);
+}
+
+void SoftwareOcclusion::render() {
+    auto start = std::chrono::steady_clock::now();
+    std::fill(masks.begin(), masks.end(), 0u);
+    std::fill(zMax0.begin(), zMax0.end(), FAR_DEPTH);
+    std::fill(zMax1.begin(), zMax1.end(), 0.0f);
+    std::fill(rowFarthest.begin(), rowFarthest.end(), FAR_DEPTH);
+    triangles.clear();
+
+    if (!draws.empty()) {
+        // Proyectar y recortar los oclusores en paralelo, cada hilo en su lista
+        projected.resize(ThreadPool::shared().size() + 1);
+        for (auto& list : projected)
+            list.clear();
+        parallelFor(static_cast<int>(draws.size()), [this](int i, int worker) { projectOccluder(draws[i], projected[worker]); });
+        for (const auto& list : projected)
+            triangles.insert(triangles.end(), list.begin(), list.end());
+
+        // De cerca a lejos: los cercanos llenan los bloques y los de atrás se descartan enseguida
+        std::sort(triangles.begin(), triangles.end(), [](const ScreenTriangle& x, const ScreenTriangle& y) { return x.zMax < y.zMax; });
+        parallelFor(BAND_COUNT, [this](int band, int) { rasterizeBand(band * BAND_ROWS, band * BAND_ROWS + BAND_ROWS - 1); });
+    }
+
+    rendered = true;
+    renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SoftwareOcclusion::rasterizeBand(int firstTileRow, int lastTileRow) {
+    for (const ScreenTriangle& triangle : triangles) {
+        int rowBegin = std::max(triangle.tileY0, firstTileRow);
+        int rowEnd = std::min(triangle.tileY1, lastTileRow);
+        for (int ty = rowBegin; ty <= rowEnd; ty++) {
+            if (triangle.zMax >= rowFarthest[ty])
+                continue;
+            int first, last;
+            if (!rowSpan(triangle, ty, first, last))
+                continue;
+            for (int tx = first; tx <= last; tx++) {
+                int tile = ty * TILES_X + tx;
+                if (triangle.zMax >= zMax0[tile])
+                    continue;
+                uint32_t coverage = tileCoverage(triangle.a, triangle.b, triangle.c, tx * TILE_WIDTH + 0.5f, ty * TILE_HEIGHT + 0.5f);
+                if (coverage != 0)
+                    updateTile(tile, coverage, triangle.zMax);
+            }
+        }
+    }
+}
+
+// Bloques de la fila ty que el triángulo puede cubrir: en cada arista, el
+// tramo de x donde es positiva en alguna de las filas de píxeles del bloque
+bool SoftwareOcclusion::rowSpan(const ScreenTriangle& triangle, int ty, int& first, int& last) {
+    float y0 = ty * TILE_HEIGHT + 0.5f;
+    float y1 = y0 + (TILE_HEIGHT - 1);
+    float low = triangle.tileX0 * TILE_WIDTH + 0.5f;
+    float high = (triangle.tileX1 + 1) * TILE_WIDTH - 0.5f;
+    for (int k = 0; k < 3; k++) {
+        float rest = triangle.c[k] + std::max(triangle.b[k] * y0, triangle.b[k] * y1);
+        if (triangle.a[k] > 0.0f)
+            low = std::max(low, -rest / triangle.a[k]);
+        else if (triangle.a[k] < 0.0f)
+            high = std::min(high, -rest / triangle.a[k]);
+        else if (rest <= 0.0f)
+            return false;
+    }
+    if (low > high)
+        return false;
+    first = std::max(triangle.tileX0, static_cast<int>(std::floor((low - 0.5f) / TILE_WIDTH)));
+    last = std::min(triangle.tileX1, static_cast<int>(std::floor((high - 0.5f) / TILE_WIDTH)));
+    return first <= last;
+}
+
+// La capa en construcción junta píxeles hasta llenar el bloque y entonces pasa
+// a ser la profundidad del bloque entero. Si el triángulo está mucho más cerca
+// que la capa, la capa se tira y empieza de nuevo con él (la heurística de
+// Hasselgren para no quedar atado a algo lejano).
+void SoftwareOcclusion::updateTile(int tile, uint32_t coverage, float zTriangle) {
+    uint32_t mask = masks[tile];
+    float layerDepth = zMax1[tile];
+    if (mask != 0 && layerDepth - zTriangle > zMax0[tile] - layerDepth)
+        mask = 0;
+    layerDepth = mask != 0 ? std::max(layerDepth, zTriangle) : zTriangle;
+    mask |= coverage;
+    if (mask == FULL_TILE) {
+        zMax0[tile] = layerDepth;
+        mask = 0;
+        int row = tile / TILES_X;
+        auto rowBegin = zMax0.begin() + row * TILES_X;
+        rowFarthest[row] = *std::max_element(rowBegin, rowBegin + TILES_X);
+    }
+    masks[tile] = mask;
+    zMax1[tile] = layerDepth;
+}
+
+bool SoftwareOcclusion::occluded(const glm::mat4& model, const MeshBounds& box) const {
+    if (!rendered || triangles.empty())
+        return false;
+
+    glm::vec4 corners[8];
+    boxCorners(viewProj * model, box, corners);
+    float nearest = FAR_DEPTH;
+    glm::vec2 low(std::numeric_limits<float>::max()), high(-std::numeric_limits<float>::max());
+    for (const glm::vec4& p : corners) {
+        if (p.z < -p.w || p.w <= 0.0f)
+            return false;
+        nearest = std::min(nearest, p.w);
+        glm::vec2 pixel = toPixels(p);
+        low = glm::min(low, pixel);
+        high = glm::max(high, pixel);
+    }
+
+    if (high.x < 0.0f || high.y < 0.0f || low.x >= WIDTH || low.y >= HEIGHT)
+        return false;
+
+    // Todos los píxeles que toca el rectángulo de la caja
+    low = glm::clamp(glm::floor(low), glm::vec2(0.0f), glm::vec2(WIDTH - 1, HEIGHT - 1));
+    high = glm::clamp(glm::floor(high), glm::vec2(0.0f), glm::vec2(WIDTH - 1, HEIGHT - 1));
+    int x0 = static_cast<int>(low.x), y0 = static_cast<int>(low.y);
+    int x1 = static_cast<int>(high.x), y1 = static_cast<int>(high.y);
+
+    for (int ty = y0 / TILE_HEIGHT; ty <= y1 / TILE_HEIGHT; ty++) {
+        int r0 = std::max(y0 - ty * TILE_HEIGHT, 0);
+        int r1 = std::min(y1 - ty * TILE_HEIGHT, TILE_HEIGHT - 1);
+        for (int tx = x0 / TILE_WIDTH; tx <= x1 / TILE_WIDTH; tx++) {
+            int c0 = std::max(x0 - tx * TILE_WIDTH, 0);
+            int c1 = std::min(x1 - tx * TILE_WIDTH, TILE_WIDTH - 1);
+            uint32_t rowBits = (0xFFu >> (TILE_WIDTH - 1 - (c1 - c0))) << c0;
+            uint32_t rect = 0;
+            for (int r = r0; r <= r1; r++)
+                rect |= rowBits << (r * 8);
+
+            // Los píxeles de la capa tienen algo a zMax1 como mucho; el resto, a zMax0
+            int tile = ty * TILES_X + tx;
+            float depth = (rect & ~masks[tile]) == 0 ? zMax1[tile] : zMax0[tile];
+            if (nearest <= depth)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::vector<float> SoftwareOcclusion::depthImage() const {
+    std::vector<float> image(size_t(WIDTH) * HEIGHT);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            int tile = (y / TILE_HEIGHT) * TILES_X + x / TILE_WIDTH;
+            uint32_t bit = 1u << ((y % TILE_HEIGHT) * 8 + x % TILE_WIDTH);
+            image[size_t(y) * WIDTH + x] = (masks[tile] & bit) ? zMax1[tile] : zMax0[tile];
+        }
+    }
+    return image;
+}
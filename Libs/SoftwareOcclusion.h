@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glm.hpp>
+#include "Culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Buffer de oclusión por software: una profundidad de baja resolución que se
+// rasteriza en la CPU con los oclusores de las mallas (los triángulos grandes
+// de los edificios) y contra la que se prueban las cajas antes de enviarlas.
+// A diferencia de OcclusionQueries, el resultado es del mismo frame.
+//
+// La profundidad es la w de clip (lineal, mayor = más lejos) y se guarda por
+// bloques de 8x4 píxeles con profundidad enmascarada (Hasselgren et al. 2016):
+// una profundidad que vale para todo el bloque (zMax0) y una capa en
+// construcción con los píxeles cubiertos (mask) y la profundidad más lejana de
+// lo que los cubre (zMax1). Un triángulo cubre un píxel solo si lo tapa entero
+// y una caja ocupa todos los píxeles que toca, así que es conservador: lo que
+// se descarta está tapado de verdad (a esta resolución).
+//
+// Por frame, desde el hilo de OpenGL: begin, addOccluder por cada malla
+// oclusora, render (proyecta y rasteriza en ThreadPool::shared) y occluded.
+class SoftwareOcclusion {
+public:
+    static constexpr int WIDTH = 512;
+    static constexpr int HEIGHT = 256;
+    static constexpr int TILE_WIDTH = 8;
+    static constexpr int TILE_HEIGHT = 4;
+    static constexpr int TILES_X = WIDTH / TILE_WIDTH;
+    static constexpr int TILES_Y = HEIGHT / TILE_HEIGHT;
+
+    // Triángulos oclusores por malla como máximo (ver extractOccluder)
+    static constexpr size_t MAX_OCCLUDER_TRIANGLES = 64;
+
+    // El del juego; las herramientas pueden crear el suyo
+    static SoftwareOcclusion& instance();
+    SoftwareOcclusion();
+
+    SoftwareOcclusion(const SoftwareOcclusion&) = delete;
+    SoftwareOcclusion& operator=(const SoftwareOcclusion&) = delete;
+
+    // Al importar: los triángulos más grandes de la malla, de a tres vértices.
+    // Son parte de la malla, así que no tapan nada que ella no tape; se ignoran
+    // los menores que una fracción de la cara más grande de su caja. Vacío si
+    // no queda ninguno.
+    static std::vector<glm::vec3> extractOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                                                  const MeshBounds& bounds);
+
+    // Empieza un frame: olvida los oclusores y el buffer anterior
+    void begin(const glm::mat4& viewProjection);
+
+    // occluder: de a tres vértices en el espacio de model, dentro de bounds; se
+    // lee en render, así que tiene que seguir vivo hasta entonces. Los
+    // oclusores fuera de la pantalla o que ocupan pocos píxeles se ignoran.
+    void addOccluder(const glm::mat4& model, const MeshBounds& bounds, const std::vector<glm::vec3>& occluder);
+
+    // Proyecta y rasteriza todo lo agregado; después vale occluded
+    void render();
+    bool ready() const { return rendered; }
+
+    // La caja (en el espacio de model) queda entera detrás de los oclusores.
+    // false si cruza el plano near.
+    bool occluded(const glm::mat4& model, const MeshBounds& box) const;
+
+    // Del último render
+    size_t occluderCount() const { return draws.size(); }
+    size_t triangleCount() const { return triangles.size(); }
+    double lastRenderMs() const { return renderMs; }
+
+    // Profundidad conservadora de cada píxel, por filas desde abajo (infinito
+    // donde no hay oclusores)
+    std::vector<float> depthImage() const;
+
+private:
+    struct OccluderDraw {
+        glm::mat4 clip;             // viewProjection * model
+        const glm::vec3* vertices;
+        size_t triangleCount;
+    };
+
+    // Triángulo ya proyectado: ecuaciones de sus aristas en píxeles del buffer,
+    // corridas medio píxel hacia adentro (positivas donde cubre el píxel entero)
+    struct ScreenTriangle {
+        float a[3], b[3], c[3];
+        float zMax;                 // w más lejana de los tres vértices
+        int tileX0, tileY0, tileX1, tileY1;
+    };
+
+    void projectOccluder(const OccluderDraw& draw, std::vector<ScreenTriangle>& out) const;
+    static void clipNear(const glm::vec4 (&clip)[3], std::vector<ScreenTriangle>& out);
+    static void setupTriangle(const glm::vec4& p0, const glm::vec4& p1, const glm::vec4& p2, std::vector<ScreenTriangle>& out);
+    void rasterizeBand(int firstTileRow, int lastTileRow);
+    static bool rowSpan(const ScreenTriangle& triangle, int ty, int& first, int& last);
+    void updateTile(int tile, uint32_t coverage, float zTriangle);
+
+    glm::mat4 viewProj = glm::mat4(1.0f);
+    std::vector<OccluderDraw> draws;
+    std::vector<std::vector<ScreenTriangle>> projected;   // uno por hilo que proyecta
+    std::vector<ScreenTriangle> triangles;                // de cerca a lejos
+    bool rendered = false;
+    double renderMs = 0.0;
+
+    // Por bloque, en estructura de arreglos
+    std::vector<uint32_t> masks;
+    std::vector<float> zMax0;
+    std::vector<float> zMax1;
+    std::vector<float> rowFarthest;   // zMax0 más lejana de cada fila de bloques
+};
@@ -0,0 +1,596 @@
+#include "TextureCache.h"
+#include "LoadProfiler.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+// Formatos S3TC: no están en glad (perfil core sin extensiones)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace {
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TextureCache& TextureCache::instance() {
+    static TextureCache cache;
+    return cache;
+}
+
+// Ruta absoluta y normalizada para que "a/../a/x.png" y "a/x.png" compartan entrada
+std::string TextureCache::resolvePath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(path, ec);
+    if (ec)
+        resolved = std::filesystem::absolute(path, ec);
+    return resolved.generic_string();
+}
+
+// Hash de 64 bits sobre los píxeles, procesando 8 bytes por iteración
+uint64_t TextureCache::hashPixels(const unsigned char* data, size_t size, int width, int height, int channels) {
+    const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+
+    uint64_t h = 0x27D4EB2F165667C5ull ^ (uint64_t(width) << 32) ^ (uint64_t(height) << 8) ^ uint64_t(channels);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t k;
+        std::memcpy(&k, data + i, 8);
+        h ^= k * prime2;
+        h = (h << 31) | (h >> 33);
+        h *= prime1;
+    }
+    for (; i < size; i++) {
+        h ^= data[i] * prime1;
+        h = (h << 11) | (h >> 53);
+        h *= prime2;
+    }
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    return h;
+}
+
+// Solo CPU: se puede llamar desde cualquier hilo
+TextureCache::DecodedImage TextureCache::decode(const std::string& path, const std::string& key, bool allowBaked) {
+    auto start = std::chrono::steady_clock::now();
+    ScopedTimer timer("Textura", path);
+
+    DecodedImage image;
+    image.path = path;
+    image.key = key;
+
+    // Preferir la versión horneada por SpeedTitansTexBake si corresponde a este archivo
+    BakedSource source;
+    BakedTexture baked;
+    if (allowBaked && BakedSource::stamp(path, source) && baked.load(BakedTexture::bakedPath(path), source)) {
+        image.isBaked = true;
+        image.bakedFormat = baked.format;
+        image.width = static_cast<int>(baked.width);
+        image.height = static_cast<int>(baked.height);
+        image.contentHash = hashPixels(baked.data.data(), baked.data.size(),
+                                       image.width, image.height, -static_cast<int>(baked.format));
+        image.data = std::move(baked.data);
+        image.mips = std::move(baked.mips);
+    } else {
+        unsigned char* pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+        if (pixels) {
+            size_t size = size_t(image.width) * image.height * image.channels;
+            image.contentHash = hashPixels(pixels, size, image.width, image.height, image.channels);
+
+            // Mipmaps en CPU (en vez de glGenerateMipmap) para poder subirlos de a uno
+            image.data.reserve(size + size / 3 + 64);
+            image.data.assign(pixels, pixels + size);
+            image.mips.push_back(BakedMipLevel{ uint32_t(image.width), uint32_t(image.height), 0, size });
+            stbi_image_free(pixels);
+
+            int width = image.width;
+            int height = image.height;
+            while (width > 1 || height > 1) {
+                std::vector<unsigned char> level = BlockCompression::downsample(image.data.data() + image.mips.back().offset,
+                                                                                width, height, image.channels);
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+                image.mips.push_back(BakedMipLevel{ uint32_t(width), uint32_t(height), image.data.size(), level.size() });
+                image.data.insert(image.data.end(), level.begin(), level.end());
+            }
+        }
+    }
+
+    image.decodeMs = elapsedMs(start);
+    return image;
+}
+
+bool TextureCache::supportsBaked() {
+    if (bakedSupport < 0) {
+        bakedSupport = 0;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+                bakedSupport = 1;
+        }
+        if (!bakedSupport)
+            std::cout << "TextureCache: sin GL_EXT_texture_compression_s3tc, se ignoran los .sttex" << std::endl;
+    }
+    return bakedSupport == 1;
+}
+
+// Copia los datos a un PBO del anillo. Devuelve el puntero que hay que pasar a
+// glTexImage2D: 0 (desplazamiento dentro del PBO) o los datos de cliente si falla el mapeo.
+const void* TextureCache::stage(const void* data, size_t size) {
+    if (pbos[0] == 0)
+        glGenBuffers(PBO_COUNT, pbos);
+    GLuint pbo = pbos[nextPbo];
+    nextPbo = (nextPbo + 1) % PBO_COUNT;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        std::memcpy(mapped, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        return nullptr;
+    }
+
+    // Sin PBO: subir directamente desde memoria del cliente
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return data;
+}
+
+TextureCache::ArrayFormat TextureCache::arrayFormat(const DecodedImage& image) {
+    ArrayFormat format;
+    format.compressed = image.isBaked;
+    format.width = image.width;
+    format.height = image.height;
+    format.levels = static_cast<int>(image.mips.size());
+    if (image.isBaked) {
+        format.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        if (image.bakedFormat == BakedFormat::BC3)
+            format.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else if (image.bakedFormat == BakedFormat::BC5)
+            format.internalFormat = GL_COMPRESSED_RG_RGTC2;
+    } else if (image.channels == 1) {
+        format.format = GL_RED;
+        format.internalFormat = GL_R8;
+    } else if (image.channels == 2) {
+        format.format = GL_RG;
+        format.internalFormat = GL_RG8;
+    } else if (image.channels == 4) {
+        format.format = GL_RGBA;
+        format.internalFormat = GL_RGBA8;
+    } else {
+        format.format = GL_RGB;
+        format.internalFormat = GL_RGB8;
+    }
+    return format;
+}
+
+void TextureCache::allocateLayer(const ArrayFormat& format, int& array, GLint& layer) {
+    int capacityOfFormat = 0;
+    for (size_t i = 0; i < arrays.size(); i++) {
+        TextureArray& candidate = arrays[i];
+        if (candidate.id == 0 || !(candidate.format == format))
+            continue;
+        capacityOfFormat += static_cast<int>(candidate.usedLayers.size());
+        if (candidate.used == static_cast<int>(candidate.usedLayers.size()))
+            continue;
+
+        auto freeLayer = std::find(candidate.usedLayers.begin(), candidate.usedLayers.end(), false);
+        *freeLayer = true;
+        candidate.used++;
+        array = static_cast<int>(i);
+        layer = static_cast<GLint>(freeLayer - candidate.usedLayers.begin());
+        return;
+    }
+
+    // Capacidad: las imágenes del mismo formato que ya esperan en la cola, y al
+    // menos lo que ya hay de ese formato (crece al doble, como un vector)
+    int waiting = 0;
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        for (const auto& image : ready) {
+            if (image.valid() && arrayFormat(image) == format)
+                waiting++;
+        }
+    }
+    int capacity = std::clamp(std::max(waiting + 1, capacityOfFormat), 1, int(MAX_LAYERS));
+
+    TextureArray created;
+    created.format = format;
+    created.usedLayers.assign(capacity, false);
+    created.usedLayers[0] = true;
+    created.used = 1;
+
+    glGenTextures(1, &created.id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, created.id);
+
+    // Memoria para todas las capas y niveles desde ya; se rellenan por partes
+    if (GLAD_GL_VERSION_4_2) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, format.levels, format.internalFormat, format.width, format.height, capacity);
+    } else {
+        int width = format.width, height = format.height;
+        for (GLint level = 0; level < format.levels; level++) {
+            if (format.compressed) {
+                // Bloques de 4x4: 8 bytes en BC1, 16 en BC3/BC5
+                size_t blockBytes = format.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+                size_t layerBytes = size_t((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, width, height, capacity, 0,
+                                       static_cast<GLsizei>(layerBytes * capacity), nullptr);
+            } else {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, width, height, capacity, 0,
+                             format.format, GL_UNSIGNED_BYTE, nullptr);
+            }
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, format.levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, format.levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    created.baseLevel = format.levels - 1;
+
+    // Reutilizar el hueco de un arreglo ya borrado
+    auto hole = std::find_if(arrays.begin(), arrays.end(), [](const TextureArray& a) { return a.id == 0; });
+    if (hole == arrays.end())
+        hole = arrays.insert(arrays.end(), TextureArray());
+    *hole = std::move(created);
+    array = static_cast<int>(hole - arrays.begin());
+    layer = 0;
+    counters.arrays++;
+}
+
+void TextureCache::refreshBaseLevel(int array) {
+    GLint base = 0;
+    for (const auto& texture : streaming) {
+        if (texture.array == array)
+            base = std::max(base, texture.level + 1);
+    }
+
+    TextureArray& target = arrays[array];
+    if (base != target.baseLevel) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, target.id);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, base);
+        target.baseLevel = base;
+    }
+}
+
+// Sube solo la cola de mipmaps (niveles de hasta TAIL_SIZE) a una capa libre
+// y deja los niveles grandes para stream()
+void TextureCache::upload(DecodedImage& image, GLuint handle, Entry& entry) {
+    ArrayFormat format = arrayFormat(image);
+    allocateLayer(format, entry.array, entry.layer);
+
+    StreamingTexture texture;
+    texture.handle = handle;
+    texture.array = entry.array;
+    texture.layer = entry.layer;
+    texture.compressed = format.compressed;
+    texture.internalFormat = format.internalFormat;
+    texture.format = format.format;
+
+    GLint levels = format.levels;
+    GLint tail = levels - 1;
+    while (tail > 0 && static_cast<int>(std::max(image.mips[tail - 1].width, image.mips[tail - 1].height)) <= TAIL_SIZE)
+        tail--;
+
+    // Toda la cola está seguida al final de data: un solo PBO
+    const BakedMipLevel& first = image.mips[tail];
+    size_t tailBytes = image.data.size() - first.offset;
+    const unsigned char* source = static_cast<const unsigned char*>(stage(image.data.data() + first.offset, tailBytes));
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[entry.array].id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (GLint level = tail; level < levels; level++) {
+        const BakedMipLevel& mip = image.mips[level];
+        const unsigned char* pixels = source + (mip.offset - first.offset);
+        if (texture.compressed)
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, entry.layer, mip.width, mip.height, 1,
+                                      texture.internalFormat, static_cast<GLsizei>(mip.size), pixels);
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, entry.layer, mip.width, mip.height, 1,
+                            texture.format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    counters.bytesUploaded += tailBytes;
+
+    if (tail > 0) {
+        texture.level = tail - 1;
+        texture.data = std::move(image.data);
+        texture.mips = std::move(image.mips);
+        streaming.push_back(std::move(texture));
+    }
+
+    // Muestrear solo los niveles que todas las capas ya tienen en la GPU
+    refreshBaseLevel(entry.array);
+}
+
+size_t TextureCache::uploadRows(StreamingTexture& texture, size_t budgetBytes) {
+    const BakedMipLevel& mip = texture.mips[texture.level];
+    int height = static_cast<int>(mip.height);
+
+    // Los formatos por bloques avanzan de a 4 filas
+    int rowStep = texture.compressed ? 4 : 1;
+    int stepCount = (height + rowStep - 1) / rowStep;
+    size_t stepBytes = mip.size / stepCount;
+    int stepsDone = texture.rowsDone / rowStep;
+    int steps = static_cast<int>(std::clamp<size_t>(budgetBytes / stepBytes, 1, size_t(stepCount - stepsDone)));
+    int rows = std::min(steps * rowStep, height - texture.rowsDone);
+    size_t bytes = size_t(steps) * stepBytes;
+
+    const void* source = stage(texture.data.data() + mip.offset + size_t(stepsDone) * stepBytes, bytes);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[texture.array].id);
+    if (texture.compressed)
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, texture.level, 0, texture.rowsDone, texture.layer, mip.width, rows, 1,
+                                  texture.internalFormat, static_cast<GLsizei>(bytes), source);
+    else
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, texture.level, 0, texture.rowsDone, texture.layer, mip.width, rows, 1,
+                        texture.format, GL_UNSIGNED_BYTE, source);
+
+    texture.rowsDone += rows;
+    if (texture.rowsDone >= height) {
+        // Nivel completo en esta capa (refreshBaseLevel decide si ya se puede muestrear)
+        texture.level--;
+        texture.rowsDone = 0;
+    }
+    return bytes;
+}
+
+void TextureCache::stream(size_t budgetBytes, double budgetMs) {
+    if (streaming.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    while (!streaming.empty() && sent < budgetBytes && elapsedMs(start) < budgetMs) {
+        // El nivel pendiente más chico de todas: la escena gana detalle de forma pareja
+        auto next = std::min_element(streaming.begin(), streaming.end(), [](const StreamingTexture& a, const StreamingTexture& b) {
+            return a.mips[a.level].size < b.mips[b.level].size;
+        });
+        int array = next->array;
+        int level = next->level;
+        sent += uploadRows(*next, budgetBytes - sent);
+        bool levelDone = next->level != level;
+        if (next->level < 0)
+            streaming.erase(next);
+        if (levelDone)
+            refreshBaseLevel(array);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    counters.bytesStreamed += sent;
+    counters.bytesUploaded += sent;
+}
+
+GLuint TextureCache::insert(DecodedImage& image, bool prefetched) {
+    if (!image.valid()) {
+        std::cout << "Cargando textura: " << image.path << " (FALLÓ)" << std::endl;
+        std::cerr << "Failed to load texture at path: " << image.path << std::endl;
+        counters.failures++;
+        return 0;
+    }
+
+    TextureTiming timing;
+    timing.path = image.path;
+    timing.decodeMs = image.decodeMs;
+    timing.bytes = image.data.size();
+    timing.baked = image.isBaked;
+
+    GLuint textureID;
+    auto contentIt = byContent.find(image.contentHash);
+    if (contentIt != byContent.end()) {
+        // Otra ruta con exactamente la misma imagen
+        textureID = contentIt->second;
+        timing.shared = true;
+        counters.contentHits++;
+    } else {
+        auto start = std::chrono::steady_clock::now();
+        ScopedTimer timer("Textura (GPU)", image.path);
+        textureID = nextHandle++;
+        Entry& entry = entries[textureID];
+        entry = Entry{ image.contentHash, 0, prefetched, 0, 0 };
+        upload(image, textureID, entry);
+        timing.uploadMs = elapsedMs(start);
+
+        byContent[image.contentHash] = textureID;
+        counters.misses++;
+        if (image.isBaked) {
+            counters.bakedLoads++;
+            counters.vramBytes += timing.bytes;
+        } else {
+            // Los drivers guardan GL_RGB como RGBA8; los mipmaps suman 1/3
+            counters.vramBytes += size_t(image.width) * image.height * 4 * 4 / 3;
+        }
+    }
+
+    std::cout << "Cargando textura: " << image.path << " (Éxito, decodificar " << timing.decodeMs
+              << " ms, subir " << timing.uploadMs << " ms" << (timing.baked ? ", horneada" : "") << (timing.shared ? ", compartida" : "") << ")" << std::endl;
+
+    byPath[image.key] = textureID;
+    loadTimings.push_back(timing);
+    return textureID;
+}
+
+std::shared_ptr<TextureBatch> TextureCache::prefetchAsync(const std::vector<std::string>& paths, int priority) {
+    auto batch = std::make_shared<TextureBatch>();
+    bool allowBaked = supportsBaked();
+
+    // Quitar duplicados y lo que ya está cargado; lo que ya se está decodificando solo se espera
+    std::unordered_set<std::string> seen;
+    for (const auto& path : paths) {
+        std::string key = resolvePath(path);
+        if (byPath.count(key) || !seen.insert(key).second)
+            continue;
+
+        batch->total++;
+        batch->remaining++;
+
+        auto flight = inFlight.find(key);
+        if (flight != inFlight.end()) {
+            flight->second.push_back(batch);
+            continue;
+        }
+        inFlight[key].push_back(batch);
+
+        // Los hilos de trabajo decodifican; el hilo de OpenGL sube en orden de llegada
+        ThreadPool::shared().submit([this, path, key, allowBaked] {
+            DecodedImage image = decode(path, key, allowBaked);
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(std::move(image));
+            readyCv.notify_one();
+        }, priority);
+    }
+
+    return batch;
+}
+
+bool TextureCache::uploadNext(bool wait) {
+    DecodedImage image;
+    {
+        std::unique_lock<std::mutex> lock(readyMutex);
+        if (wait)
+            readyCv.wait(lock, [this] { return !ready.empty(); });
+        else if (ready.empty())
+            return false;
+        image = std::move(ready.front());
+        ready.pop_front();
+    }
+
+    std::string key = image.key;
+    insert(image, true);
+
+    auto flight = inFlight.find(key);
+    if (flight != inFlight.end()) {
+        for (auto& batch : flight->second)
+            batch->remaining--;
+        inFlight.erase(flight);
+    }
+    return true;
+}
+
+void TextureCache::uploadReady(double budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+    while (uploadNext(false)) {
+        if (elapsedMs(start) >= budgetMs)
+            break;
+    }
+}
+
+void TextureCache::finish(const std::shared_ptr<TextureBatch>& batch) {
+    while (!batch->done())
+        uploadNext(true);
+}
+
+void TextureCache::prefetch(const std::vector<std::string>& paths) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<TextureBatch> batch = prefetchAsync(paths);
+    if (batch->total == 0)
+        return;
+    finish(batch);
+
+    std::cout << "TextureCache: " << batch->total << " imágenes en paralelo ("
+              << ThreadPool::shared().size() << " hilos) en " << elapsedMs(start) << " ms" << std::endl;
+}
+
+GLuint TextureCache::acquire(const std::string& path) {
+    std::string key = resolvePath(path);
+
+    // Misma ruta ya cargada
+    auto pathIt = byPath.find(key);
+    if (pathIt != byPath.end()) {
+        Entry& entry = entries[pathIt->second];
+        if (entry.prefetched)
+            entry.prefetched = false;   // primer uso: ya se contó al precargar
+        else
+            counters.pathHits++;
+        entry.refCount++;
+        return pathIt->second;
+    }
+
+    // Si otro lote la está decodificando, esperar a que llegue en vez de repetir el trabajo
+    while (inFlight.count(key))
+        uploadNext(true);
+    pathIt = byPath.find(key);
+    if (pathIt != byPath.end()) {
+        entries[pathIt->second].prefetched = false;
+        entries[pathIt->second].refCount++;
+        return pathIt->second;
+    }
+
+    DecodedImage image = decode(path, key, supportsBaked());
+    GLuint textureID = insert(image, false);
+    if (textureID != 0)
+        entries[textureID].refCount++;
+    return textureID;
+}
+
+TextureLocation TextureCache::location(GLuint handle) const {
+    TextureLocation location;
+    auto it = entries.find(handle);
+    if (it != entries.end()) {
+        location.array = arrays[it->second.array].id;
+        location.layer = it->second.layer;
+    }
+    return location;
+}
+
+void TextureCache::release(GLuint handle) {
+    auto it = entries.find(handle);
+    if (it == entries.end())
+        return;
+
+    if (--it->second.refCount > 0)
+        return;
+
+    // Quitar todas las rutas que apuntaban a esta textura
+    for (auto pathIt = byPath.begin(); pathIt != byPath.end();) {
+        if (pathIt->second == handle)
+            pathIt = byPath.erase(pathIt);
+        else
+            ++pathIt;
+    }
+    byContent.erase(it->second.contentHash);
+
+    int array = it->second.array;
+    TextureArray& target = arrays[array];
+    target.usedLayers[it->second.layer] = false;
+    target.used--;
+    entries.erase(it);
+
+    streaming.erase(std::remove_if(streaming.begin(), streaming.end(),
+                                   [handle](const StreamingTexture& texture) { return texture.handle == handle; }),
+                    streaming.end());
+
+    // La capa queda con basura hasta que otra imagen la ocupe; el arreglo se
+    // borra cuando no le queda ninguna
+    if (target.used == 0) {
+        glDeleteTextures(1, &target.id);
+        target = TextureArray();
+        counters.arrays--;
+    } else {
+        refreshBaseLevel(array);
+    }
+}
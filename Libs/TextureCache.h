@@ -0,0 +1,217 @@
+#pragma once
+
+#include <glad.h>
+#include "BakedTexture.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Contadores del registro de texturas
+struct TextureCacheStats {
+    unsigned int pathHits = 0;      // misma ruta ya cargada
+    unsigned int contentHits = 0;   // ruta distinta, mismos píxeles
+    unsigned int misses = 0;        // decodificada y subida a la GPU
+    unsigned int failures = 0;      // no se pudo leer o decodificar
+    unsigned int bakedLoads = 0;    // cargadas desde un .sttex comprimido
+    size_t bytesUploaded = 0;       // bytes enviados a la GPU (todos los niveles subidos)
+    size_t vramBytes = 0;           // estimación con la cadena de mipmaps completa
+    size_t bytesStreamed = 0;       // niveles finos subidos por stream() después de crear la textura
+    unsigned int arrays = 0;        // GL_TEXTURE_2D_ARRAY vivos
+};
+
+// Dónde quedó una textura: una capa de un GL_TEXTURE_2D_ARRAY compartido
+struct TextureLocation {
+    GLuint array = 0;
+    GLint layer = 0;
+};
+
+// Tiempos de carga de una imagen (en milisegundos)
+struct TextureTiming {
+    std::string path;
+    double decodeMs = 0.0;   // stbi_load + hash, en un hilo de trabajo
+    double uploadMs = 0.0;   // reservar niveles + subir la cola de mipmaps, en el hilo de OpenGL
+    size_t bytes = 0;
+    bool shared = false;     // reutilizó una textura con el mismo contenido
+    bool baked = false;      // vino de un .sttex (bloques + mipmaps precalculados)
+};
+
+// Lote pedido con prefetchAsync; se completa a medida que el hilo de OpenGL sube sus imágenes
+struct TextureBatch {
+    size_t total = 0;
+    size_t remaining = 0;
+
+    bool done() const { return remaining == 0; }
+    float progress() const { return total ? 1.0f - static_cast<float>(remaining) / total : 1.0f; }
+};
+
+// Registro global de texturas compartido por todos los Model.
+// Deduplica por ruta resuelta y por hash del contenido decodificado,
+// y entrega identificadores con contador de referencias.
+//
+// Las imágenes del mismo tamaño y formato comparten un GL_TEXTURE_2D_ARRAY,
+// una por capa, para que las mallas que las usan no cambien de textura.
+//
+// Las capas se crean con solo los mipmaps pequeños (hasta TAIL_SIZE) y
+// GL_TEXTURE_BASE_LEVEL apuntando al más grande de ellos, así se pueden usar
+// en el mismo frame. stream() sube el resto por franjas, de menor a mayor.
+// BASE_LEVEL es del arreglo entero: sigue a la capa más atrasada.
+class TextureCache {
+public:
+    // Lado máximo (en texels) de los niveles que se suben al crear la textura
+    static const int TAIL_SIZE = 128;
+
+    static TextureCache& instance();
+
+    // Decodifica en paralelo todas las imágenes que aún no estén cargadas
+    // y las sube desde el hilo actual (que debe tener el contexto OpenGL)
+    void prefetch(const std::vector<std::string>& paths);
+
+    // Igual que prefetch pero sin esperar: los hilos de trabajo decodifican con
+    // la prioridad dada y uploadReady/finish suben desde el hilo de OpenGL
+    std::shared_ptr<TextureBatch> prefetchAsync(const std::vector<std::string>& paths, int priority = 0);
+
+    // Sube imágenes ya decodificadas hasta agotar el presupuesto (ms); no bloquea
+    void uploadReady(double budgetMs);
+
+    // Bloquea hasta que todo el lote esté subido
+    void finish(const std::shared_ptr<TextureBatch>& batch);
+
+    // Sube niveles finos pendientes hasta agotar cualquiera de los dos presupuestos.
+    // Llamar una vez por frame desde el hilo de OpenGL.
+    void stream(size_t budgetBytes, double budgetMs);
+
+    // Texturas que todavía no tienen el nivel 0 en la GPU
+    size_t pendingStreams() const { return streaming.size(); }
+
+    // Devuelve el identificador de la textura (0 si falla) e incrementa su contador
+    GLuint acquire(const std::string& path);
+
+    // Arreglo y capa donde está la textura
+    TextureLocation location(GLuint handle) const;
+
+    // Decrementa el contador y libera la capa al llegar a cero
+    void release(GLuint handle);
+
+    const TextureCacheStats& stats() const { return counters; }
+    const std::vector<TextureTiming>& timings() const { return loadTimings; }
+    size_t size() const { return entries.size(); }
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+private:
+    struct Entry {
+        uint64_t contentHash;
+        int refCount;
+        bool prefetched;   // cargada por prefetch y aún sin usuarios
+        int array;         // índice en arrays
+        GLint layer;
+    };
+
+    // Lo que tienen que compartir dos imágenes para ir al mismo arreglo
+    struct ArrayFormat {
+        GLenum internalFormat = 0;
+        GLenum format = 0;           // solo sin comprimir
+        bool compressed = false;
+        int width = 0, height = 0, levels = 0;
+
+        bool operator==(const ArrayFormat& other) const {
+            return internalFormat == other.internalFormat && width == other.width &&
+                   height == other.height && levels == other.levels;
+        }
+    };
+
+    struct TextureArray {
+        GLuint id = 0;               // 0 = hueco libre en arrays
+        ArrayFormat format;
+        std::vector<bool> usedLayers;
+        int used = 0;
+        GLint baseLevel = 0;
+    };
+
+    // Imagen decodificada en CPU (o leída ya comprimida) con toda su cadena de
+    // mipmaps, lista para subir
+    struct DecodedImage {
+        std::string path;
+        std::string key;
+        int width = 0, height = 0, channels = 0;
+        bool isBaked = false;
+        BakedFormat bakedFormat = BakedFormat::BC1;
+        std::vector<unsigned char> data;      // todos los niveles seguidos, del 0 al último
+        std::vector<BakedMipLevel> mips;
+        uint64_t contentHash = 0;
+        double decodeMs = 0.0;
+
+        bool valid() const { return !mips.empty(); }
+    };
+
+    // Textura ya usable a la que le faltan los niveles finos
+    struct StreamingTexture {
+        GLuint handle = 0;
+        int array = 0;
+        GLint layer = 0;
+        bool compressed = false;
+        GLenum internalFormat = 0;
+        GLenum format = 0;
+        std::vector<unsigned char> data;
+        std::vector<BakedMipLevel> mips;
+        int level = 0;        // nivel que se está subiendo (BASE_LEVEL = level + 1)
+        int rowsDone = 0;     // filas de texels de ese nivel ya subidas
+    };
+
+    static const int PBO_COUNT = 3;
+    // Capas por arreglo como máximo (GL 3.3 garantiza 256)
+    static const int MAX_LAYERS = 64;
+
+    TextureCache() = default;
+
+    static std::string resolvePath(const std::string& path);
+    static uint64_t hashPixels(const unsigned char* data, size_t size, int width, int height, int channels);
+    static DecodedImage decode(const std::string& path, const std::string& key, bool allowBaked);
+
+    // Crea la textura (o reutiliza una idéntica) y libera los píxeles
+    GLuint insert(DecodedImage& image, bool prefetched);
+    static ArrayFormat arrayFormat(const DecodedImage& image);
+    // Busca una capa libre de ese formato o crea un arreglo nuevo
+    void allocateLayer(const ArrayFormat& format, int& array, GLint& layer);
+    // BASE_LEVEL del arreglo = el nivel completo más grueso entre sus capas en streaming
+    void refreshBaseLevel(int array);
+    // Toma una capa, sube la cola de mipmaps y deja el resto en streaming
+    void upload(DecodedImage& image, GLuint handle, Entry& entry);
+    // Sube una franja del nivel pendiente; devuelve los bytes enviados
+    size_t uploadRows(StreamingTexture& texture, size_t budgetBytes);
+    const void* stage(const void* data, size_t size);
+
+    // ¿El driver acepta BC1/BC3 (GL_EXT_texture_compression_s3tc)?
+    bool supportsBaked();
+
+    // Saca una imagen decodificada de la cola (esperando si wait) y la sube
+    bool uploadNext(bool wait);
+
+    std::unordered_map<std::string, GLuint> byPath;
+    std::unordered_map<uint64_t, GLuint> byContent;
+    std::unordered_map<GLuint, Entry> entries;
+    TextureCacheStats counters;
+    std::vector<TextureTiming> loadTimings;
+
+    // Imágenes en decodificación y los lotes que las esperan
+    std::unordered_map<std::string, std::vector<std::shared_ptr<TextureBatch>>> inFlight;
+    std::mutex readyMutex;
+    std::condition_variable readyCv;
+    std::deque<DecodedImage> ready;
+
+    std::vector<StreamingTexture> streaming;
+    std::vector<TextureArray> arrays;
+    GLuint nextHandle = 1;
+
+    GLuint pbos[PBO_COUNT] = {};
+    int nextPbo = 0;
+    int bakedSupport = -1;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Pool de hilos sencillo para trabajo de CPU (decodificar imágenes, etc.).
+// Nunca llama a OpenGL: los resultados se suben desde el hilo principal.
+// Las tareas con menor número de prioridad salen antes; a igual prioridad, en orden de llegada.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount)
+    {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Pool compartido por todo el programa (deja un núcleo libre para el hilo de OpenGL)
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+
+    template <typename F>
+    auto submit(F&& task, int priority = 0) -> std::future<decltype(task())>
+    {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(Task{ priority, nextSequence++, [packaged] { (*packaged)(); } });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+private:
+    struct Task {
+        int priority;
+        uint64_t sequence;
+        std::function<void()> run;
+    };
+
+    struct RunsLater {
+        bool operator()(const Task& a, const Task& b) const
+        {
+            if (a.priority != b.priority)
+                return a.priority > b.priority;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    void workerLoop()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty())
+                    return;
+                task = std::move(const_cast<Task&>(tasks.top()).run);
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::priority_queue<Task, std::vector<Task>, RunsLater> tasks;
+    uint64_t nextSequence = 0;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
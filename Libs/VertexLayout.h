@@ -0,0 +1,250 @@
+#pragma once
+
+#include <glad.h>
+#include <glm.hpp>
+#include <gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Vértice completo tal como sale de Assimp. Solo existe en CPU durante la
+// importación; a la GPU van únicamente los atributos del VertexLayout elegido.
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+    glm::vec3 Tangent;
+    glm::vec3 Bitangent;
+};
+
+// Caja de la malla para las posiciones cuantizadas: posición = unorm * scale + offset.
+// Con los layouts de floats queda en la identidad.
+struct VertexQuantization {
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::vec3 offset = glm::vec3(0.0f);
+
+    static VertexQuantization fromBounds(const glm::vec3& min, const glm::vec3& max)
+    {
+        VertexQuantization q;
+        q.offset = min;
+        q.scale = max - min;
+        return q;
+    }
+};
+
+// Atributos de vértice: ubicación en el shader, formato en la GPU y cómo se
+// copian desde Vertex
+namespace VertexAttrib {
+    struct Position {
+        static constexpr GLuint location = 0;
+        static constexpr GLint components = 3;
+        static constexpr GLenum type = GL_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = sizeof(glm::vec3);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out) { std::memcpy(out, &v.Position, size); }
+    };
+
+    struct Normal {
+        static constexpr GLuint location = 1;
+        static constexpr GLint components = 3;
+        static constexpr GLenum type = GL_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = sizeof(glm::vec3);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out) { std::memcpy(out, &v.Normal, size); }
+    };
+
+    struct TexCoords {
+        static constexpr GLuint location = 2;
+        static constexpr GLint components = 2;
+        static constexpr GLenum type = GL_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = sizeof(glm::vec2);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out) { std::memcpy(out, &v.TexCoords, size); }
+    };
+
+    struct Tangent {
+        static constexpr GLuint location = 3;
+        static constexpr GLint components = 3;
+        static constexpr GLenum type = GL_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = sizeof(glm::vec3);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out) { std::memcpy(out, &v.Tangent, size); }
+    };
+
+    struct Bitangent {
+        static constexpr GLuint location = 4;
+        static constexpr GLint components = 3;
+        static constexpr GLenum type = GL_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = sizeof(glm::vec3);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out) { std::memcpy(out, &v.Bitangent, size); }
+    };
+
+    // Posición como unorm16 dentro del AABB de la malla (w de relleno para alinear a 4 bytes)
+    struct QuantizedPosition {
+        static constexpr GLuint location = 0;
+        static constexpr GLint components = 4;
+        static constexpr GLenum type = GL_UNSIGNED_SHORT;
+        static constexpr GLboolean normalized = GL_TRUE;
+        static constexpr size_t size = 4 * sizeof(uint16_t);
+        static void write(const Vertex& v, const VertexQuantization& q, unsigned char* out)
+        {
+            uint16_t packed[4] = { 0, 0, 0, 0 };
+            for (int k = 0; k < 3; k++) {
+                float t = q.scale[k] > 0.0f ? (v.Position[k] - q.offset[k]) / q.scale[k] : 0.0f;
+                packed[k] = static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+            }
+            std::memcpy(out, packed, size);
+        }
+    };
+
+    // Normal octaédrica en 2 x snorm16 (se decodifica en model.vert)
+    struct OctNormal {
+        static constexpr GLuint location = 1;
+        static constexpr GLint components = 2;
+        static constexpr GLenum type = GL_SHORT;
+        static constexpr GLboolean normalized = GL_TRUE;
+        static constexpr size_t size = 2 * sizeof(int16_t);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out)
+        {
+            glm::vec3 n = v.Normal;
+            float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+            glm::vec2 e = l1 > 0.0f ? glm::vec2(n.x, n.y) / l1 : glm::vec2(0.0f);
+            if (n.z < 0.0f) {
+                // Hemisferio inferior: se pliega sobre las diagonales
+                glm::vec2 folded = glm::vec2(1.0f - std::fabs(e.y), 1.0f - std::fabs(e.x));
+                e.x = e.x >= 0.0f ? folded.x : -folded.x;
+                e.y = e.y >= 0.0f ? folded.y : -folded.y;
+            }
+            int16_t packed[2];
+            for (int k = 0; k < 2; k++)
+                packed[k] = static_cast<int16_t>(std::lround(std::clamp(e[k], -1.0f, 1.0f) * 32767.0f));
+            std::memcpy(out, packed, size);
+        }
+    };
+
+    // UV en half float
+    struct HalfTexCoords {
+        static constexpr GLuint location = 2;
+        static constexpr GLint components = 2;
+        static constexpr GLenum type = GL_HALF_FLOAT;
+        static constexpr GLboolean normalized = GL_FALSE;
+        static constexpr size_t size = 2 * sizeof(uint16_t);
+        static void write(const Vertex& v, const VertexQuantization&, unsigned char* out)
+        {
+            uint32_t packed = glm::packHalf2x16(v.TexCoords);
+            std::memcpy(out, &packed, size);
+        }
+    };
+}
+
+// Formato de vértice intercalado definido en compilación por su lista de atributos
+template <typename... Attribs>
+struct VertexLayout {
+    static constexpr size_t stride = (Attribs::size + ...);
+    static constexpr uint32_t locations = ((1u << Attribs::location) | ...);
+
+    template <typename Attrib>
+    static constexpr bool has = (std::is_same_v<Attrib, Attribs> || ...);
+
+    // Posiciones relativas al AABB de la malla (necesita VertexQuantization al empaquetar y dibujar)
+    static constexpr bool quantized = has<VertexAttrib::QuantizedPosition>;
+
+    // Empaqueta un vértice completo en stride bytes
+    static void pack(const Vertex& vertex, const VertexQuantization& quantization, unsigned char* out)
+    {
+        size_t offset = 0;
+        ((Attribs::write(vertex, quantization, out + offset), offset += Attribs::size), ...);
+    }
+
+    // Declara los atributos en el VAO ligado (con el VBO ligado a GL_ARRAY_BUFFER)
+    static void setupAttributes()
+    {
+        size_t offset = 0;
+        (setupAttribute<Attribs>(offset), ...);
+    }
+
+private:
+    template <typename Attrib>
+    static void setupAttribute(size_t& offset)
+    {
+        glEnableVertexAttribArray(Attrib::location);
+        glVertexAttribPointer(Attrib::location, Attrib::components, Attrib::type, Attrib::normalized,
+                              static_cast<GLsizei>(stride), reinterpret_cast<const void*>(offset));
+        offset += Attrib::size;
+    }
+};
+
+// Posición, normal y UV: lo que consume shaders/model.vert (32 bytes)
+using StandardLayout = VertexLayout<VertexAttrib::Position, VertexAttrib::Normal, VertexAttrib::TexCoords>;
+
+// Con espacio tangente para variantes con normal map (56 bytes)
+using NormalMappedLayout = VertexLayout<VertexAttrib::Position, VertexAttrib::Normal, VertexAttrib::TexCoords,
+                                        VertexAttrib::Tangent, VertexAttrib::Bitangent>;
+
+// Los mismos atributos que StandardLayout cuantizados (16 bytes); model.vert los
+// decodifica con positionScale/positionOffset y octNormals
+using QuantizedLayout = VertexLayout<VertexAttrib::QuantizedPosition, VertexAttrib::OctNormal, VertexAttrib::HalfTexCoords>;
+
+// Identificador de los layouts conocidos en tiempo de ejecución (se guarda en la caché de mallas)
+enum class VertexFormat : uint32_t {
+    Standard = 1,
+    NormalMapped = 2,
+    Quantized = 3
+};
+
+// Llama a f con una instancia vacía del layout que corresponde al formato
+template <typename F>
+decltype(auto) withVertexLayout(VertexFormat format, F&& f)
+{
+    switch (format) {
+    case VertexFormat::NormalMapped:
+        return f(NormalMappedLayout{});
+    case VertexFormat::Quantized:
+        return f(QuantizedLayout{});
+    case VertexFormat::Standard:
+    default:
+        return f(StandardLayout{});
+    }
+}
+
+inline size_t vertexStride(VertexFormat format)
+{
+    return withVertexLayout(format, [](auto layout) { return decltype(layout)::stride; });
+}
+
+inline bool isQuantized(VertexFormat format)
+{
+    return withVertexLayout(format, [](auto layout) { return decltype(layout)::quantized; });
+}
+
+inline bool needsTangents(VertexFormat format)
+{
+    return withVertexLayout(format, [](auto layout) { return decltype(layout)::template has<VertexAttrib::Tangent>; });
+}
+
+// Atributos por dibujo (no por vértice): en multi-draw vienen de un búfer con
+// divisor 1 indexado por baseInstance; en el resto son el valor constante que
+// se fija con glVertexAttrib antes de cada glDraw*.
+namespace DrawAttrib {
+    const GLuint Scale = 5;    // VertexQuantization::scale
+    const GLuint Offset = 6;   // VertexQuantization::offset
+    const GLuint Layer = 7;    // capas de las texturas en sus arreglos (ver Mesh::layers)
+    const GLuint Object = 8;   // ranura en ObjectBuffer
+    const GLuint Fade = 9;     // transición entre niveles de detalle (ver LodSelector::fade)
+    const uint32_t locations = (1u << Scale) | (1u << Offset) | (1u << Layer) | (1u << Object) | (1u << Fade);
+}
+
+// El layout más chico que cubre las ubicaciones que declara el shader (bit i = location i).
+// quantize elige la versión cuantizada cuando existe para esos atributos.
+inline VertexFormat chooseVertexFormat(uint32_t shaderLocations, bool quantize = false)
+{
+    shaderLocations &= ~DrawAttrib::locations;
+    if ((shaderLocations & ~StandardLayout::locations) == 0)
+        return quantize ? VertexFormat::Quantized : VertexFormat::Standard;
+    return VertexFormat::NormalMapped;
+}
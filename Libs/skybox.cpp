@@ -1,4 +1,6 @@
 #include "Skybox.h"
+#include "FrameUniforms.h"
+#include "LoadProfiler.h"
 #include <stb_image.h>
 #include <iostream>
 #include <filesystem>
@@ -52,7 +54,22 @@ Skybox::Skybox(const std::vector<std::string>& faces)
     : shader("Shaders/skybox.vert", "Shaders/skybox.frag")
 {
     setupSkybox();
-    cubemapTexture = loadCubemap(faces);
+    CubemapFaces decoded;
+    decodeFaces(faces, decoded);
+    cubemapTexture = loadCubemap(decoded);
+}
+
+Skybox::Skybox(const CubemapFaces& decoded)
+    : shader("Shaders/skybox.vert", "Shaders/skybox.frag")
+{
+    setupSkybox();
+    cubemapTexture = loadCubemap(decoded);
+}
+
+CubemapFaces::~CubemapFaces()
+{
+    for (auto& face : faces)
+        stbi_image_free(face.data);
 }
 
 Skybox::~Skybox()
@@ -76,17 +93,20 @@ void Skybox::setupSkybox()
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
     glBindVertexArray(0);
+
+    // El sampler siempre lee la unidad 0: se fija una vez
+    FrameUniforms::attach(shader);
+    shader.Use();
+    if (shader.hasUniform("skybox")) {
+        shader.setInt("skybox", 0);
+    } else {
+        std::cerr << "Uniform 'skybox' not found in shader. Program ID: " << shader.Program << std::endl;
+    }
+    glUseProgram(0);
 }
 
-GLuint Skybox::loadCubemap(const std::vector<std::string>& faces)
+void Skybox::decodeFaces(const std::vector<std::string>& faces, CubemapFaces& out, std::atomic<float>* progress)
 {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(false);
-
     std::filesystem::path currentPath = std::filesystem::current_path();
     std::cout << "DEBUG: Current working directory (from Skybox): " << currentPath << std::endl;
 
@@ -105,23 +125,43 @@ GLuint Skybox::loadCubemap(const std::vector<std::string>& faces)
 
         std::cout << "DEBUG: Attempting to load (normalized path): " << finalPathString << std::endl;
 
-        unsigned char *data = stbi_load(finalPathString.c_str(), &width, &height, &nrChannels, 0);
-        if (data)
+        CubemapFaces::Face face;
+        face.path = finalPathString;
+        ScopedTimer timer("Cubemap", faces[i]);
+        face.data = stbi_load(finalPathString.c_str(), &face.width, &face.height, &face.channels, 0);
+        timer.stop();
+        if (!face.data)
+        {
+            std::cout << "Failed to load cubemap texture at path: " << finalPathString << ". STB_IMAGE error: " << stbi_failure_reason() << std::endl;
+        }
+        out.faces.push_back(face);
+
+        if (progress)
+            progress->store(static_cast<float>(i + 1) / faces.size());
+    }
+}
+
+GLuint Skybox::loadCubemap(const CubemapFaces& decoded)
+{
+    ScopedTimer timer("Cubemap", "subir 6 caras");
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+
+    for (unsigned int i = 0; i < decoded.faces.size(); i++)
+    {
+        const CubemapFaces::Face& face = decoded.faces[i];
+        if (face.data)
         {
             GLenum format = GL_RGB;
-            if (nrChannels == 4)
+            if (face.channels == 4)
                 format = GL_RGBA;
 
             glTexImage2D(
                 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data
+                0, format, face.width, face.height, 0, format, GL_UNSIGNED_BYTE, face.data
             );
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Failed to load cubemap texture at path: " << finalPathString << ". STB_IMAGE error: " << stbi_failure_reason() << std::endl;
-            stbi_image_free(data);
         }
     }
 
@@ -135,28 +175,15 @@ GLuint Skybox::loadCubemap(const std::vector<std::string>& faces)
     return textureID;
 }
 
-void Skybox::Draw(const glm::mat4& view, const glm::mat4& projection)
+void Skybox::submit(RenderQueue& queue)
 {
-    glDepthFunc(GL_LEQUAL);
-
-    shader.Use();
-
-    glm::mat4 viewNoTranslation = glm::mat4(glm::mat3(view));
-
-    shader.setMat4("view", viewNoTranslation);
-    shader.setMat4("projection", projection);
+    RenderPacket packet{ this, 0, shader.Program, VAO };
+    queue.submit(RenderPass::Background, RenderQueue::materialId({ VAO, cubemapTexture }), glm::vec3(0.0f), packet);
+}
 
-    glBindVertexArray(VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-    if (shader.hasUniform("skybox")) {
-        shader.setInt("skybox", 0);
-    } else {
-        // Corrección del error de compilación: Usar shader.Program para obtener el ID del programa GLSL
-        std::cerr << "Uniform 'skybox' not found in shader. Program ID: " << shader.Program << std::endl;
-    }
+void Skybox::draw(const RenderPacket&, RenderState& state)
+{
+    state.bindTexture(0, GL_TEXTURE_CUBE_MAP, cubemapTexture);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-
-    glDepthFunc(GL_LESS);
-}
\ No newline at end of file
+    state.countDraw();
+}
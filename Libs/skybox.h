@@ -1,21 +1,46 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include "Shader.h"
+#include "RenderQueue.h"
 
-class Skybox
+// Caras del cubemap ya decodificadas en CPU (se pueden preparar en otro hilo)
+struct CubemapFaces {
+    struct Face {
+        unsigned char* data = nullptr;
+        int width = 0, height = 0, channels = 0;
+        std::string path;
+    };
+    std::vector<Face> faces;
+
+    CubemapFaces() = default;
+    ~CubemapFaces();
+    CubemapFaces(const CubemapFaces&) = delete;
+    CubemapFaces& operator=(const CubemapFaces&) = delete;
+};
+
+class Skybox : public Renderable
 {
 public:
     Skybox(const std::vector<std::string>& faces);
+    // Hilo de OpenGL: crea el skybox a partir de caras ya decodificadas
+    explicit Skybox(const CubemapFaces& decoded);
     ~Skybox();
 
-    void Draw(const glm::mat4& view, const glm::mat4& projection);
+    // Solo CPU: lee las 6 imágenes. progress (opcional) avanza de 0 a 1
+    static void decodeFaces(const std::vector<std::string>& faces, CubemapFaces& out, std::atomic<float>* progress = nullptr);
+
+    // En la pasada de fondo: se dibuja después de los opacos, solo donde no tapan.
+    // Las matrices salen del bloque Frame (ver FrameUniforms).
+    void submit(RenderQueue& queue);
+    void draw(const RenderPacket& packet, RenderState& state) override;
 
 private:
-    GLuint loadCubemap(const std::vector<std::string>& faces);
+    GLuint loadCubemap(const CubemapFaces& decoded);
     GLuint VAO, VBO;
     GLuint cubemapTexture;
     Shader shader;
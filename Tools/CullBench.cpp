@@ -0,0 +1,185 @@
+// SpeedTitansCullBench: compara el culling caja por caja (cullBounds) con el
+// recorrido del BVH sobre ciudades sintéticas de cada vez más objetos, con la
+// misma densidad y la misma cámara a nivel de calle que el juego (far = 100).
+// Después mide el buffer de oclusión por software con los edificios como
+// oclusores: cuánto tarda y cuántas cajas saca además del frustum.
+//
+// Uso: SpeedTitansCullBench [objetos máximos]
+
+#include "Bvh.h"
+#include "Culling.h"
+#include "SoftwareOcclusion.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+    const int VIEWS = 64;             // orientaciones de cámara por medición
+    const float DENSITY = 0.02f;      // objetos por unidad cuadrada
+    const float MIN_PIXELS = 2.0f;
+
+    // Edificios, postes y autos: cajas de tamaños muy distintos sobre el plano
+    std::vector<MeshBounds> makeCity(size_t count, std::mt19937& rng) {
+        float side = std::sqrt(count / DENSITY);
+        std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+        std::uniform_real_distribution<float> kind(0.0f, 1.0f);
+        std::uniform_real_distribution<float> unit(0.5f, 1.0f);
+
+        std::vector<MeshBounds> city(count);
+        for (MeshBounds& box : city) {
+            glm::vec3 size;
+            float k = kind(rng);
+            if (k < 0.3f)
+                size = glm::vec3(8.0f, 20.0f, 8.0f) * unit(rng);
+            else if (k < 0.7f)
+                size = glm::vec3(2.0f, 1.5f, 4.0f) * unit(rng);
+            else
+                size = glm::vec3(0.2f, 3.0f, 0.2f) * unit(rng);
+            glm::vec3 base(position(rng), 0.0f, position(rng));
+            box.min = base - glm::vec3(size.x, 0.0f, size.z) * 0.5f;
+            box.max = base + glm::vec3(size.x * 0.5f, size.y, size.z * 0.5f);
+        }
+        return city;
+    }
+
+    const glm::mat4 PROJECTION = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+
+    glm::mat4 cameraView(int i) {
+        float yaw = 6.2831853f * i / VIEWS;
+        glm::vec3 eye(0.0f, 1.5f, 0.0f);
+        return glm::lookAt(eye, eye + glm::vec3(std::cos(yaw), -0.05f, std::sin(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    std::vector<CullView> makeViews() {
+        std::vector<CullView> views;
+        for (int i = 0; i < VIEWS; i++)
+            views.push_back(CullView::make(PROJECTION, cameraView(i), 600.0f, MIN_PIXELS));
+        return views;
+    }
+
+    // Las seis caras de la caja (lo que extractOccluder saca de un edificio sin detalles)
+    std::vector<glm::vec3> boxTriangles(const MeshBounds& box) {
+        const int faces[6][4] = { { 0, 1, 3, 2 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 3, 7, 5 } };
+        std::vector<glm::vec3> triangles;
+        for (const auto& face : faces) {
+            glm::vec3 corner[4];
+            for (int k = 0; k < 4; k++) {
+                int c = face[k];
+                corner[k] = glm::vec3((c & 1) ? box.max.x : box.min.x, (c & 2) ? box.max.y : box.min.y, (c & 4) ? box.max.z : box.min.z);
+            }
+            triangles.insert(triangles.end(), { corner[0], corner[1], corner[2], corner[0], corner[2], corner[3] });
+        }
+        return triangles;
+    }
+
+    double elapsedUs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxObjects = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 18;
+    std::mt19937 rng(1234);
+    std::vector<CullView> views = makeViews();
+
+    std::printf("Culling (%s), %d vistas por medición, tiempos en microsegundos por vista\n", cullingBackend(), VIEWS);
+    std::printf("%9s %8s %9s %9s %10s %10s %9s %9s %9s\n", "objetos", "visibles", "plana", "bvh", "cajas bvh",
+                "nodos", "build", "refit", "plana/bvh");
+
+    for (size_t count = 256; count <= maxObjects; count *= 4) {
+        std::vector<MeshBounds> city = makeCity(count, rng);
+
+        Bvh bvh;
+        auto start = std::chrono::steady_clock::now();
+        bvh.build(city);
+        double buildUs = elapsedUs(start);
+
+        // Refit después de mover todo un poco (el peor caso de objetos dinámicos)
+        for (MeshBounds& box : city) {
+            box.min.y += 0.1f;
+            box.max.y += 0.1f;
+        }
+        start = std::chrono::steady_clock::now();
+        bvh.refit(city);
+        double refitUs = elapsedUs(start);
+
+        BoundsSoA flat;
+        flat.reserve(count);
+        for (const MeshBounds& box : city)
+            flat.add(box.min, box.max);
+
+        VisibilityBits flatVisible, bvhVisible;
+        flatVisible.resize(count, true);
+        CullStats flatStats, bvhStats;
+
+        start = std::chrono::steady_clock::now();
+        for (const CullView& view : views)
+            flatStats += cullBounds(flat, 0, count, view, flatVisible);
+        double flatUs = elapsedUs(start) / VIEWS;
+
+        start = std::chrono::steady_clock::now();
+        for (const CullView& view : views)
+            bvhStats += bvh.cull(view, bvhVisible);
+        double bvhUs = elapsedUs(start) / VIEWS;
+
+        std::printf("%9zu %8zu %9.1f %9.1f %10zu %10zu %9.0f %9.0f %8.1fx\n", count, bvhStats.visible() / VIEWS,
+                    flatUs, bvhUs, bvhStats.boxTests / VIEWS, bvh.nodeCount(), buildUs, refitUs,
+                    bvhUs > 0.0 ? flatUs / bvhUs : 0.0);
+        if (flatStats.visible() != bvhStats.visible())
+            std::printf("  aviso: la lista plana vio %zu y el BVH %zu\n", flatStats.visible(), bvhStats.visible());
+    }
+
+    std::printf("\nOclusión por software (%dx%d, %s), edificios como oclusores, promedios por vista\n",
+                SoftwareOcclusion::WIDTH, SoftwareOcclusion::HEIGHT, cullingBackend());
+    std::printf("%9s %9s %10s %9s %9s %9s %10s %10s\n", "objetos", "oclusores", "triángulos", "frustum", "tapados",
+                "sacados", "raster ms", "prueba us");
+
+    SoftwareOcclusion occlusion;
+    for (size_t count = 1024; count <= std::min<size_t>(maxObjects, 1u << 16); count *= 4) {
+        std::vector<MeshBounds> city = makeCity(count, rng);
+        std::vector<std::vector<glm::vec3>> occluders(count);
+        for (size_t i = 0; i < count; i++) {
+            if (city[i].max.y - city[i].min.y > 5.0f)
+                occluders[i] = boxTriangles(city[i]);
+        }
+        BoundsSoA flat;
+        flat.reserve(count);
+        for (const MeshBounds& box : city)
+            flat.add(box.min, box.max);
+
+        VisibilityBits visible;
+        visible.resize(count, true);
+        size_t inFrustum = 0, hidden = 0, occluderTotal = 0, triangleTotal = 0;
+        double renderMs = 0.0, testUs = 0.0;
+        for (int v = 0; v < VIEWS; v++) {
+            occlusion.begin(PROJECTION * cameraView(v));
+            for (size_t i = 0; i < count; i++)
+                occlusion.addOccluder(glm::mat4(1.0f), city[i], occluders[i]);
+            occlusion.render();
+            renderMs += occlusion.lastRenderMs();
+            occluderTotal += occlusion.occluderCount();
+            triangleTotal += occlusion.triangleCount();
+
+            cullBounds(flat, 0, count, views[v], visible);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++) {
+                if (!visible.test(i))
+                    continue;
+                inFrustum++;
+                hidden += occlusion.occluded(glm::mat4(1.0f), city[i]);
+            }
+            testUs += elapsedUs(start);
+        }
+        std::printf("%9zu %9zu %10zu %9zu %9zu %8.0f%% %10.3f %10.1f\n", count, occluderTotal / VIEWS, triangleTotal / VIEWS,
+                    inFrustum / VIEWS, hidden / VIEWS, inFrustum > 0 ? 100.0 * hidden / inFrustum : 0.0, renderMs / VIEWS,
+                    testUs / VIEWS);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// SpeedTitansMeshReport: importa cada Modelos/*/scene.gltf con Assimp (sin OpenGL),
+// pasa MeshOptimizer por todas sus mallas y muestra ACMR/ATVR antes y después.
+// Después genera sus niveles de detalle con MeshSimplifier y muestra los
+// triángulos de cada nivel, cuántas mallas los tienen y cuánto tardó.
+//
+// Uso: SpeedTitansMeshReport [carpeta Modelos]
+
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Los mismos flags que Model::import con el layout estándar
+static const unsigned int IMPORT_FLAGS =
+    aiProcess_Triangulate |
+    aiProcess_FlipUVs |
+    aiProcess_GenSmoothNormals |
+    aiProcess_JoinIdenticalVertices |
+    aiProcess_RemoveRedundantMaterials |
+    aiProcess_FindInvalidData |
+    aiProcess_OptimizeMeshes;
+
+// Triángulos por nivel de detalle de un modelo
+struct LodReport {
+    size_t triangles[MeshSimplifier::MAX_LODS] = {};
+    size_t meshesWithLods = 0;
+    double milliseconds = 0.0;
+
+    void add(const LodReport& other) {
+        for (size_t level = 0; level < MeshSimplifier::MAX_LODS; level++)
+            triangles[level] += other.triangles[level];
+        meshesWithLods += other.meshesWithLods;
+        milliseconds += other.milliseconds;
+    }
+};
+
+static MeshOptimizeReport optimizeMesh(const aiMesh* mesh, LodReport& lodReport) {
+    std::vector<Vertex> vertices(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+        Vertex& vertex = vertices[i];
+        vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        if (mesh->mNormals)
+            vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+        if (mesh->mTextureCoords[0])
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+    }
+
+    std::vector<GLuint> indices;
+    indices.reserve(size_t(mesh->mNumFaces) * 3);
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices != 3)
+            continue;   // puntos y líneas sueltos
+        indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+    }
+
+    MeshOptimizeReport report = MeshOptimizer::optimize(vertices, indices);
+
+    // Los niveles simplificados en las mallas sin huecos (las que no se simplifican cuentan en el nivel 0)
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MeshLod> lods = MeshSimplifier::buildLods(vertices, indices);
+    lodReport.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (size_t level = 0; level < lods.size(); level++)
+        lodReport.triangles[level] += lods[level].indexCount / 3;
+    if (lods.size() > 1)
+        lodReport.meshesWithLods++;
+    return report;
+}
+
+static void printReport(const std::string& name, const MeshOptimizeReport& report, size_t meshes, size_t shortIndexMeshes) {
+    std::printf("  %-12s %5zu mallas %9zu triángulos  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  índices de 16 bits: %zu/%zu\n",
+                name.c_str(), meshes, report.triangles, report.before.acmr, report.after.acmr,
+                report.before.atvr, report.after.atvr, shortIndexMeshes, meshes);
+}
+
+static void printLods(const LodReport& report, size_t meshes) {
+    std::printf("  %-12s LOD: triángulos %zu/%zu/%zu/%zu, %zu/%zu mallas con niveles, %.0f ms\n", "",
+                report.triangles[0], report.triangles[1], report.triangles[2], report.triangles[3],
+                report.meshesWithLods, meshes, report.milliseconds);
+}
+
+int main(int argc, char** argv) {
+    fs::path root = argc > 1 ? fs::path(argv[1]) : fs::path("Modelos");
+    if (!fs::is_directory(root)) {
+        std::cerr << "No existe la carpeta " << root << std::endl;
+        return 1;
+    }
+
+    std::vector<fs::path> sources;
+    for (const auto& model : fs::directory_iterator(root)) {
+        fs::path gltf = model.path() / "scene.gltf";
+        if (fs::is_regular_file(gltf))
+            sources.push_back(gltf);
+    }
+    std::sort(sources.begin(), sources.end());
+
+    std::cout << "Caché de vértices FIFO de " << MeshOptimizer::CACHE_SIZE << " entradas" << std::endl;
+
+    MeshOptimizeReport all;
+    LodReport allLods;
+    size_t allMeshes = 0, allShort = 0;
+    int failures = 0;
+
+    for (const auto& source : sources) {
+        auto start = std::chrono::steady_clock::now();
+
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(source.string(), IMPORT_FLAGS);
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
+            std::cerr << "No se pudo importar " << source << ": " << importer.GetErrorString() << std::endl;
+            failures++;
+            continue;
+        }
+
+        MeshOptimizeReport report;
+        LodReport lods;
+        size_t shortIndexMeshes = 0;
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+            MeshOptimizeReport mesh = optimizeMesh(scene->mMeshes[i], lods);
+            report.add(mesh);
+            if (mesh.vertices <= 65536)
+                shortIndexMeshes++;
+        }
+
+        printReport(source.parent_path().filename().string(), report, scene->mNumMeshes, shortIndexMeshes);
+        printLods(lods, scene->mNumMeshes);
+        std::printf("  %-12s %.0f ms\n", "", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        all.add(report);
+        allLods.add(lods);
+        allMeshes += scene->mNumMeshes;
+        allShort += shortIndexMeshes;
+    }
+
+    printReport("total", all, allMeshes, allShort);
+    printLods(allLods, allMeshes);
+    return failures == 0 ? 0 : 1;
+}
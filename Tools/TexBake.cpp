@@ -0,0 +1,198 @@
+// SpeedTitansTexBake: convierte las texturas JPEG/PNG de Modelos/*/textures
+// a archivos .sttex comprimidos por bloques (BC1/BC3/BC5) con todos sus mipmaps.
+//
+// Uso: SpeedTitansTexBake [carpeta Modelos] [--force]
+
+#include "BakedTexture.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct BakeResult {
+    fs::path source;
+    bool baked = false;
+    bool skipped = false;
+    BakedFormat format = BakedFormat::BC1;
+    int width = 0, height = 0;
+    size_t uncompressedBytes = 0;   // RGBA8 + glGenerateMipmap, como en la carga actual
+    size_t bakedBytes = 0;
+    double ms = 0.0;
+};
+
+static std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static bool isSourceImage(const fs::path& path) {
+    std::string ext = lower(path.extension().string());
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png";
+}
+
+static BakedFormat chooseFormat(const fs::path& path, const unsigned char* rgba, size_t texels) {
+    if (lower(path.filename().string()).find("normal") != std::string::npos)
+        return BakedFormat::BC5;
+
+    for (size_t i = 0; i < texels; i++) {
+        if (rgba[i * 4 + 3] < 250)
+            return BakedFormat::BC3;
+    }
+    return BakedFormat::BC1;
+}
+
+static const char* formatName(BakedFormat format) {
+    switch (format) {
+        case BakedFormat::BC1: return "BC1";
+        case BakedFormat::BC3: return "BC3";
+        case BakedFormat::BC5: return "BC5";
+    }
+    return "?";
+}
+
+static BakeResult bakeTexture(const fs::path& source, bool force) {
+    auto start = std::chrono::steady_clock::now();
+
+    BakeResult result;
+    result.source = source;
+
+    BakedSource stamp;
+    BakedSource::stamp(source.string(), stamp);
+    fs::path target = BakedTexture::bakedPath(source.string());
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+    if (!pixels) {
+        std::cerr << "No se pudo leer " << source << ": " << stbi_failure_reason() << std::endl;
+        return result;
+    }
+    result.width = width;
+    result.height = height;
+    result.uncompressedBytes = size_t(width) * height * 4 * 4 / 3;
+
+    // Reutilizar el .sttex si se horneó desde esta misma versión de la imagen
+    BakedTexture texture;
+    if (!force && texture.load(target.string(), stamp)) {
+        stbi_image_free(pixels);
+        result.skipped = true;
+        result.format = texture.format;
+        result.bakedBytes = texture.byteSize();
+        return result;
+    }
+
+    texture.format = chooseFormat(source, pixels, size_t(width) * height);
+    texture.width = static_cast<uint32_t>(width);
+    texture.height = static_cast<uint32_t>(height);
+
+    std::vector<unsigned char> level(pixels, pixels + size_t(width) * height * 4);
+    stbi_image_free(pixels);
+
+    int w = width, h = height;
+    for (;;) {
+        size_t offset = texture.data.size();
+        BlockCompression::compressImage(level.data(), w, h, texture.format, texture.data);
+        texture.mips.push_back(BakedMipLevel{ static_cast<uint32_t>(w), static_cast<uint32_t>(h), offset, texture.data.size() - offset });
+
+        if (w == 1 && h == 1)
+            break;
+        level = BlockCompression::downsample(level.data(), w, h);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    if (!texture.save(target.string(), stamp)) {
+        std::cerr << "No se pudo escribir " << target << std::endl;
+        return result;
+    }
+
+    result.baked = true;
+    result.format = texture.format;
+    result.bakedBytes = texture.byteSize();
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    fs::path root = "Modelos";
+    bool force = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--force")
+            force = true;
+        else
+            root = arg;
+    }
+
+    if (!fs::is_directory(root)) {
+        std::cerr << "No existe la carpeta " << root << std::endl;
+        return 1;
+    }
+
+    // Modelos/<modelo>/textures/*.{jpg,jpeg,png}
+    std::vector<fs::path> sources;
+    for (const auto& model : fs::directory_iterator(root)) {
+        fs::path textures = model.path() / "textures";
+        if (!fs::is_directory(textures))
+            continue;
+        for (const auto& entry : fs::directory_iterator(textures)) {
+            if (entry.is_regular_file() && isSourceImage(entry.path()))
+                sources.push_back(entry.path());
+        }
+    }
+    std::sort(sources.begin(), sources.end());
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::future<BakeResult>> jobs;
+    for (const auto& source : sources)
+        jobs.push_back(ThreadPool::shared().submit([source, force] { return bakeTexture(source, force); }));
+
+    struct Totals { size_t files = 0, before = 0, after = 0; };
+    std::map<std::string, Totals> perModel;
+    Totals all;
+    int failures = 0;
+
+    for (auto& job : jobs) {
+        BakeResult result = job.get();
+        if (!result.baked && !result.skipped) {
+            failures++;
+            continue;
+        }
+
+        std::cout << (result.skipped ? "  al día  " : "  horneada ") << result.source.generic_string()
+                  << " " << result.width << "x" << result.height << " " << formatName(result.format)
+                  << "  " << result.uncompressedBytes / 1024 << " KB -> " << result.bakedBytes / 1024 << " KB";
+        if (result.baked)
+            std::cout << " (" << static_cast<int>(result.ms) << " ms)";
+        std::cout << std::endl;
+
+        Totals& totals = perModel[result.source.parent_path().parent_path().filename().string()];
+        totals.files++;
+        totals.before += result.uncompressedBytes;
+        totals.after += result.bakedBytes;
+        all.files++;
+        all.before += result.uncompressedBytes;
+        all.after += result.bakedBytes;
+    }
+
+    std::cout << "\nVRAM estimada (RGBA8 + mipmaps -> bloques + mipmaps):" << std::endl;
+    for (const auto& [name, totals] : perModel) {
+        std::cout << "  " << name << ": " << totals.files << " texturas, "
+                  << totals.before / (1024 * 1024) << " MB -> " << totals.after / (1024 * 1024) << " MB" << std::endl;
+    }
+    std::cout << "  total: " << all.files << " texturas, " << all.before / (1024 * 1024) << " MB -> "
+              << all.after / (1024 * 1024) << " MB en "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <chrono>
 #include "Shader.h"
 #include "Camera.h"
 #include "Model.h"
@@ -8,6 +9,12 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Skybox.h"
+#include "AssetManager.h"
+#include "FrameUniforms.h"
+#include "ObjectBuffer.h"
+#include "OcclusionQueries.h"
+#include "SoftwareOcclusion.h"
+#include "LoadProfiler.h"
 #include <filesystem>
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
@@ -35,6 +42,16 @@ float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 bool cursorEnabled = false;
 bool showMainMenu = true; // aqui se muestra el menú principal al inicio
+bool recursosListos = false; // ciudad, meteoro y skybox ya están en la GPU
+bool mostrarPerfil = false; // ventana "Perfil de carga" (F3)
+bool mostrarEstadisticas = false; // ventana "Estadísticas" (F2)
+float envioEscenaMs = 0.0f;       // CPU de llenar y ejecutar la cola de dibujo en el último frame
+bool cullingActivo = true;        // frustum culling de las mallas (F2)
+float pixelesMinimos = 2.0f;      // culling por tamaño: diámetro proyectado mínimo, 0 = apagado
+CullStats cullingEscena;          // mallas probadas y descartadas en el último frame
+LodStats lodEscena;               // mallas y triángulos por nivel de detalle en el último frame
+ImpostorStats impostorEscena;     // clusters dibujados como impostor en el último frame
+RenderQueue colaDibujo;           // skybox, ciudad y meteoro, ordenados por clave
 
 // Sonido
 float volumenCity = 1.0f; // 1.0 = volumen de la musica (se mantiene por si acaso, aunque no se use directamente para un slider)
@@ -79,7 +96,8 @@ void processInput(GLFWwindow *window)
 
     // Lógica para abrir/cerrar el menú principal con TAB
     if (glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS) {
-        if (!tabPressedLastFrame) {
+        // No se puede salir del menú hasta que la escena esté cargada
+        if (!tabPressedLastFrame && (!showMainMenu || recursosListos)) {
             showMainMenu = !showMainMenu;
             cursorEnabled = showMainMenu;
             glfwSetInputMode(window, GLFW_CURSOR, showMainMenu ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
@@ -98,6 +116,20 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    // F3 muestra/oculta el perfil de carga
+    static bool f3PressedLastFrame = false;
+    bool f3Pressed = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (f3Pressed && !f3PressedLastFrame)
+        mostrarPerfil = !mostrarPerfil;
+    f3PressedLastFrame = f3Pressed;
+
+    // F2 muestra/oculta las estadísticas de render
+    static bool f2PressedLastFrame = false;
+    bool f2Pressed = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
+    if (f2Pressed && !f2PressedLastFrame)
+        mostrarEstadisticas = !mostrarEstadisticas;
+    f2PressedLastFrame = f2Pressed;
+
     // Cambiar entre cámaras
     if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
         activeCamera = &freeCamera;
@@ -165,6 +197,8 @@ void processInput(GLFWwindow *window)
             if (!enterPressedLastFrame) {
                 switch (selectedMenuOption) {
                     case 0: // Iniciar Viaje
+                        if (!recursosListos)
+                            break;
                         std::cout << "¡Viaje iniciado desde teclado!\n";
                         showMainMenu = false;
                         cursorEnabled = false;
@@ -239,7 +273,22 @@ void processInput(GLFWwindow *window)
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    // --sin-cuantizar: vértices con floats completos (para comparar tiempo de frame y error visual)
+    // --mapas-normales: vértices con espacio tangente, para la variante NORMAL_MAP
+    bool cuantizarVertices = true;
+    bool mapasNormales = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--sin-cuantizar")
+            cuantizarVertices = false;
+        else if (std::string(argv[i]) == "--mapas-normales")
+            mapasNormales = true;
+    }
+
+    LoadProfiler& perfil = LoadProfiler::instance();
+    perfil.begin();
+
+    ScopedTimer initTimer("Inicio", "GLFW + ventana + GLAD");
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -266,8 +315,14 @@ int main() {
         std::cout << "Error al inicializar GLAD" << std::endl;
         return -1;
     }
+    initTimer.stop();
+
+    // glMultiDrawElementsIndirect pide GL 4.3; si no, la lista guardada se envía de a un comando
+    if (!DrawList::indirectSupported())
+        Model::drawPath = DrawPath::CachedLoop;
 
     // Inicializar Dear ImGui
+    ScopedTimer imguiTimer("Inicio", "ImGui (contexto, fuentes, backend)");
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -290,6 +345,7 @@ int main() {
 
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+    imguiTimer.stop();
 
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -304,7 +360,22 @@ int main() {
     glEnable(GL_DEPTH_TEST);
     glDisable(GL_CULL_FACE);
 
-    Shader shader("Shaders/model.vert", "Shaders/model.frag");
+    // Lanzar todos los programas antes de esperar al primero: con compilación en
+    // paralelo el skybox se compila mientras se termina el modelo
+    ShaderCache::instance().precompile("Shaders/skybox.vert", "Shaders/skybox.frag");
+    ShaderCache::instance().precompile("Shaders/occlusion.vert", "Shaders/occlusion.frag");
+    ShaderVariants sombreadoModelo("Shaders/model.vert", "Shaders/model.frag", FrameUniforms::attach);
+    FrameUniforms datosFrame;   // cámara y luz: un solo búfer para el modelo y el skybox
+
+    // Los vértices se empaquetan solo con los atributos que declara model.vert
+    // (con NORMAL_MAP si se pidieron mapas de normales)
+    const Shader& shaderFormato = mapasNormales ? sombreadoModelo.get(MaterialFeature::NormalMap) : sombreadoModelo.base();
+    VertexFormat formatoVertices = chooseVertexFormat(shaderFormato.attributeLocations(), cuantizarVertices);
+    sombreadoModelo.precompileAll(needsTangents(formatoVertices));
+    std::cout << "Formato de vértices: " << vertexStride(formatoVertices) << " bytes por vértice" << std::endl;
+
+    // Los recursos se cargan en segundo plano; el menú se dibuja desde el primer frame
+    AssetManager assets;
 
     // Skybox
     std::vector<std::string> faces = {
@@ -315,25 +386,19 @@ int main() {
         "Modelos/skybox/haze_ft.jpg",
         "Modelos/skybox/haze_bk.jpg"
     };
-    Skybox skybox(faces);
+    AssetHandle<Skybox> skybox = assets.loadSkybox(faces, AssetPriority::High);
 
     //cargar modelo
-    Model ciudad("Modelos/ciudad/scene.gltf");
-    Model Meteoro("Modelos/meteoro/scene.gltf");
-
+    AssetHandle<Model> ciudad = assets.loadModel("Modelos/ciudad/scene.gltf", formatoVertices, AssetPriority::High);
+    AssetHandle<Model> Meteoro = assets.loadModel("Modelos/meteoro/scene.gltf", formatoVertices, AssetPriority::Normal);
 
     //Sonido
-    if (LoadWavFile("Sounds/city.wav", buffer)) {
-        alGenSources(1, &sourceCity);
-        alSourcei(sourceCity, AL_BUFFER, buffer);
-        alSourcei(sourceCity, AL_LOOPING, AL_TRUE); // Esta línea hace que la música se reproduzca en bucle
-        alSourcef(sourceCity, AL_GAIN, volumenCity); // Se usa el volumen inicial (1.0f)
-        if (musicEnabled) { // Solo reproduce si musicEnabled es true al inicio
-            alSourcePlay(sourceCity);
-        }
-    } else {
-        std::cerr << "Advertencia: No se pudo cargar Sounds/city.wav\n";
-    }
+    AssetHandle<SoundBuffer> musica = assets.loadSound("Sounds/city.wav", AssetPriority::Low);
+    bool musicaIniciada = false;
+
+    bool primerFrame = true;
+    float tiempoInicio = glfwGetTime();
+    ScopedTimer primerFrameTimer("Inicio", "primer frame (atlas de fuentes ImGui)");
 
     while (!glfwWindowShouldClose(window)) {
         float currentFrame = glfwGetTime();
@@ -345,6 +410,32 @@ int main() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        // Subir a la GPU lo que ya terminaron los hilos de carga (presupuesto por frame en ms)
+        assets.update(8.0);
+        if (!recursosListos && assets.requiredReady()) {
+            recursosListos = true;
+            std::cout << "Escena lista en " << (glfwGetTime() - tiempoInicio) << " s" << std::endl;
+            perfil.markSceneReady();
+            const ShaderCacheStats& shaders = ShaderCache::instance().stats();
+            std::cout << "ShaderCache: " << shaders.binaries << " desde binario (" << shaders.binaryMs << " ms), "
+                      << shaders.compiled << " compilados (" << shaders.compileMs << " ms), "
+                      << shaders.rejected << " binarios rechazados" << std::endl;
+            perfil.writeJson("load_profile.json");
+        }
+
+        // Sonido: crear la fuente en cuanto el .wav esté cargado
+        if (!musicaIniciada && musica.state() == AssetState::Resident) {
+            musicaIniciada = true;
+            buffer = musica.get()->buffer;
+            alGenSources(1, &sourceCity);
+            alSourcei(sourceCity, AL_BUFFER, buffer);
+            alSourcei(sourceCity, AL_LOOPING, AL_TRUE); // Esta línea hace que la música se reproduzca en bucle
+            alSourcef(sourceCity, AL_GAIN, volumenCity); // Se usa el volumen inicial (1.0f)
+            if (musicEnabled) { // Solo reproduce si musicEnabled es true al inicio
+                alSourcePlay(sourceCity);
+            }
+        }
+
         processInput(window); // Llama a processInput después de ImGui::NewFrame()
 
         // Si el menú principal está activo
@@ -374,7 +465,7 @@ int main() {
             // Cálculo del espaciado para centrar verticalmente el contenido (Título + Botones)
             float buttonHeight = 50.0f;
             float buttonSpacing = 20.0f;
-            float totalButtonHeight = (buttonHeight + buttonSpacing) * 4.0f; // 4 botones
+            float totalButtonHeight = (buttonHeight + buttonSpacing) * 4.0f + (recursosListos ? 0.0f : buttonSpacing * 2.0f); // 4 botones + barra de carga
             float spacingBetweenTitleAndButtons = 50.0f; // Espacio deseado entre el título y el primer botón
             float totalContentHeight = textSize.y + spacingBetweenTitleAndButtons + totalButtonHeight;
 
@@ -398,6 +489,15 @@ int main() {
             float buttonWidth = 300.0f;
             float buttonXPos = (SCR_WIDTH - buttonWidth) * 0.5f;
 
+            // Barra de carga mientras los recursos terminan de subir
+            if (!recursosListos) {
+                std::string cargando = assets.currentName();
+                ImGui::SetCursorPosX(buttonXPos);
+                ImGui::ProgressBar(assets.progress(), ImVec2(buttonWidth, buttonSpacing),
+                                   cargando.empty() ? "Cargando..." : cargando.c_str());
+                ImGui::Spacing();
+            }
+
             // Botón "Iniciar Viaje"
             ImGui::SetCursorPosX(buttonXPos);
             // Aplicar estilo de resaltado si está seleccionado
@@ -406,7 +506,10 @@ int main() {
                 ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.2f, 0.6f, 0.9f, 1.0f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.1f, 0.4f, 0.7f, 1.0f));
             }
-            if (ImGui::Button("Iniciar Viaje", ImVec2(buttonWidth, buttonHeight))) {
+            ImGui::BeginDisabled(!recursosListos);
+            bool iniciarPulsado = ImGui::Button("Iniciar Viaje", ImVec2(buttonWidth, buttonHeight));
+            ImGui::EndDisabled();
+            if (iniciarPulsado) {
                 std::cout << "¡Viaje iniciado!\n";
                 showMainMenu = false;
                 cursorEnabled = false;
@@ -520,7 +623,7 @@ int main() {
 
 
         // Si el menú está activo, limpiar el fondo con un color sólido para que no se vea la escena 3D
-        if (showMainMenu) {
+        if (showMainMenu || !recursosListos) {
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Fondo negro cuando el menú está activo
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         } else {
@@ -528,34 +631,43 @@ int main() {
             glClearColor(0.8f, 0.8f, 0.8f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            glm::mat4 projection = glm::perspective(glm::radians(activeCamera->GetZoom()), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            const float planoLejano = 100.0f;
+            glm::mat4 projection = glm::perspective(glm::radians(activeCamera->GetZoom()), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, planoLejano);
             glm::mat4 view = activeCamera->GetViewMatrix();
 
-            // SKYBOX primero
-            skybox.Draw(view, projection);
+            // Tiempo de CPU de enviar los dibujos (para comparar los caminos de Model::drawPath)
+            auto envioInicio = std::chrono::steady_clock::now();
 
-            // MODELO
-            shader.Use();
+            FrameUniformData frame;
+            frame.view = view;
+            frame.projection = projection;
+            frame.skyboxView = glm::mat4(glm::mat3(view));
+            frame.viewPos = glm::vec4(activeCamera->GetPosition(), 1.0f);
+            frame.lightPos = glm::vec4(lightPos, 1.0f);
+            frame.lightColor = glm::vec4(lightColor, 1.0f);
+            datosFrame.update(frame);
 
+            // Los modelos descartan en submit las mallas fuera del frustum o demasiado chicas
+            CullView vistaCulling = CullView::make(projection, view, static_cast<float>(SCR_HEIGHT), pixelesMinimos);
+            colaDibujo.begin(activeCamera->GetPosition(), planoLejano, cullingActivo ? &vistaCulling : nullptr);
+            // Los niveles de detalle se eligen con la misma vista, haya culling o no
+            colaDibujo.setDetailView(vistaCulling);
+
+            // SKYBOX: la cola lo dibuja después de los opacos
+            if (skybox.ready())
+                skybox.get()->submit(colaDibujo);
+
+            // MODELO
             glm::mat4 modelMatrix = glm::mat4(1.0f);
 
             //probar para centrar el mapa
             modelMatrix = glm::scale(modelMatrix, glm::vec3(escalaModelo));
 
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(90.0f), glm::vec3(30.0f, 1.0f,-1.0f)); // Rota 90 grados alrededor del eje Y
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, -3.0f, 0.0f)); // Baja el modelo 3 unidades en Y
-
-            glUniformMatrix4fv(glGetUniformLocation(shader.Program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-            glUniformMatrix4fv(glGetUniformLocation(shader.Program, "view"), 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(shader.Program, "model"), 1, GL_FALSE, glm::value_ptr(modelMatrix));
+            // Los nodos del glTF ya la dejan con Y hacia arriba (vienen horneados en
+            // los vértices): solo se corre 3 unidades hacia atrás, donde estaba
+            modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, -3.0f));
 
-            glUniform3fv(glGetUniformLocation(shader.Program, "lightPos"), 1, glm::value_ptr(lightPos));
-            glUniform3fv(glGetUniformLocation(shader.Program, "lightColor"), 1, glm::value_ptr(lightColor));
-            glUniform3fv(glGetUniformLocation(shader.Program, "viewPos"), 1, glm::value_ptr(activeCamera->GetPosition()));
-
-            ciudad.Draw(shader.Program);
-
-            // DIBUJAR METEORO (seguirá al carro)
+            // METEORO (seguirá al carro)
             glm::mat4 meteoroMatrix = glm::mat4(1.0f);
 
             // 1. Mover a la posición del carro
@@ -567,20 +679,135 @@ int main() {
             meteoroMatrix = glm::rotate(meteoroMatrix, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
 
-            // 3. Escalar
-            meteoroMatrix = glm::scale(meteoroMatrix, glm::vec3(0.25f, 0.3f, 0.1f));
+            // 3. Ajustar su altura y centrarlo sobre el carro
+            meteoroMatrix = glm::translate(meteoroMatrix, glm::vec3(0.0f, 0.07f, 0.3f));
 
-            // 4. Rotarlo acostado como antes
-            meteoroMatrix = glm::rotate(meteoroMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+            // 4. Escalar: sus nodos del glTF ya lo acuestan y lo achican (0.206);
+            // esto lo estira a las proporciones del carro
+            meteoroMatrix = glm::scale(meteoroMatrix, glm::vec3(1.21f, 1.45f, 1.41f));
 
-            // 5. Ajustar su altura (si seguía flotando o muy abajo)
-            meteoroMatrix = glm::translate(meteoroMatrix, glm::vec3(0.0f, -3.0f, 0.0f));
+            // Oclusión por software: los oclusores de los modelos se rasterizan en la
+            // CPU antes de que cada modelo pruebe las cajas de sus mallas en submit
+            SoftwareOcclusion& oclusionCpu = SoftwareOcclusion::instance();
+            oclusionCpu.begin(projection * view);
+            if (cullingActivo && Model::softwareOcclusion) {
+                if (ciudad.ready())
+                    ciudad.get()->addOccluders(oclusionCpu, modelMatrix);
+                if (Meteoro.ready())
+                    Meteoro.get()->addOccluders(oclusionCpu, meteoroMatrix);
+                oclusionCpu.render();
+            }
 
-            glUniformMatrix4fv(glGetUniformLocation(shader.Program, "model"), 1, GL_FALSE, glm::value_ptr(meteoroMatrix));
-            Meteoro.Draw(shader.Program);
+            if (ciudad.ready())
+                ciudad.get()->submit(colaDibujo, sombreadoModelo, modelMatrix);
+            if (Meteoro.ready())
+                Meteoro.get()->submit(colaDibujo, sombreadoModelo, meteoroMatrix);
+
+            cullingEscena = CullStats();
+            if (ciudad.ready())
+                cullingEscena += ciudad.get()->cullStats();
+            if (Meteoro.ready())
+                cullingEscena += Meteoro.get()->cullStats();
+            lodEscena = LodStats();
+            if (ciudad.ready())
+                lodEscena += ciudad.get()->lodStats();
+            if (Meteoro.ready())
+                lodEscena += Meteoro.get()->lodStats();
+            impostorEscena = ImpostorStats();
+            if (ciudad.ready())
+                impostorEscena += ciudad.get()->impostorStats();
+            if (Meteoro.ready())
+                impostorEscena += Meteoro.get()->impostorStats();
+
+            // Matrices de todos los objetos, con sus matrices normales, en un solo envío
+            ObjectBuffer::instance().upload();
+            colaDibujo.execute();
+            // Cajas de las consultas de oclusión contra la profundidad que quedó
+            OcclusionQueries::instance().flush();
+            envioEscenaMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - envioInicio).count();
         }
 
 
+        if (mostrarPerfil)
+            perfil.drawWindow(&mostrarPerfil);
+
+        if (mostrarEstadisticas) {
+            // Promedio móvil para que el número se pueda leer
+            static float frameMsPromedio = 0.0f;
+            frameMsPromedio = frameMsPromedio * 0.95f + deltaTime * 1000.0f * 0.05f;
+
+            size_t bytesVertices = 0;
+            if (ciudad.ready())
+                bytesVertices += ciudad.get()->gpuVertexBytes();
+            if (Meteoro.ready())
+                bytesVertices += Meteoro.get()->gpuVertexBytes();
+
+            ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Estadísticas", &mostrarEstadisticas, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Text("Frame: %.2f ms (%.0f FPS)", frameMsPromedio, frameMsPromedio > 0.0f ? 1000.0f / frameMsPromedio : 0.0f);
+            ImGui::Text("Vértices: %zu bytes por vértice%s", vertexStride(formatoVertices),
+                        isQuantized(formatoVertices) ? " (cuantizados)" : "");
+            ImGui::Text("VBO: %.1f MB", bytesVertices / (1024.0 * 1024.0));
+            static float envioPromedio = 0.0f;
+            envioPromedio = envioPromedio * 0.95f + envioEscenaMs * 0.05f;
+            int camino = static_cast<int>(Model::drawPath);
+            ImGui::RadioButton("Malla por malla", &camino, static_cast<int>(DrawPath::MeshLoop));
+            ImGui::SameLine();
+            ImGui::RadioButton("Lista guardada", &camino, static_cast<int>(DrawPath::CachedLoop));
+            ImGui::SameLine();
+            ImGui::BeginDisabled(!DrawList::indirectSupported());
+            ImGui::RadioButton("Multi-draw indirecto", &camino, static_cast<int>(DrawPath::MultiDrawIndirect));
+            ImGui::EndDisabled();
+            Model::drawPath = static_cast<DrawPath>(camino);
+            ImGui::Text("Envío de la escena (CPU): %.3f ms", envioPromedio);
+            const RenderStats& cola = colaDibujo.stats();
+            ImGui::Text("Cola: %zu paquetes, %zu llamadas de dibujo, %zu objetos", cola.packets, cola.drawCalls,
+                        ObjectBuffer::instance().objectCount());
+            ImGui::Text("Cambios de estado: %zu hechos, %zu evitados", cola.issued(), cola.saved());
+            ImGui::Text("Variantes de shader compiladas: %zu", sombreadoModelo.compiledCount());
+            ImGui::Checkbox("Frustum culling", &cullingActivo);
+            ImGui::SameLine();
+            ImGui::Checkbox("Jerarquía (BVH)", &Model::hierarchicalCulling);
+            ImGui::SameLine();
+            ImGui::Text("(%s)", cullingBackend());
+            ImGui::Checkbox("Oclusión (consultas)", &Model::occlusionCulling);
+            ImGui::SameLine();
+            ImGui::Checkbox("Oclusión (CPU)", &Model::softwareOcclusion);
+            ImGui::SliderFloat("Tamaño mínimo (px)", &pixelesMinimos, 0.0f, 16.0f, "%.1f");
+            ImGui::Text("Mallas: %zu visibles, %zu fuera del frustum, %zu demasiado chicas, %zu tapadas (%zu según la CPU)",
+                        cullingEscena.visible(), cullingEscena.outside, cullingEscena.small,
+                        cullingEscena.occluded + cullingEscena.softwareOccluded, cullingEscena.softwareOccluded);
+            ImGui::Text("Cajas probadas: %zu, consultas de oclusión: %zu", cullingEscena.boxTests,
+                        OcclusionQueries::instance().lastIssued());
+            // Dibujos que saca la oclusión por software de los que deja el frustum
+            const SoftwareOcclusion& oclusionCpu = SoftwareOcclusion::instance();
+            size_t enFrustum = cullingEscena.tested - cullingEscena.outside - cullingEscena.small;
+            ImGui::Text("Oclusión CPU: %zu de %zu dibujos del frustum (%.0f%%), %zu oclusores, %zu triángulos, %.2f ms",
+                        cullingEscena.softwareOccluded, enFrustum, enFrustum > 0 ? 100.0 * cullingEscena.softwareOccluded / enFrustum : 0.0,
+                        oclusionCpu.occluderCount(), oclusionCpu.triangleCount(), oclusionCpu.lastRenderMs());
+            ImGui::Text("  hechos/evitados: programas %zu/%zu  VAO %zu/%zu  texturas %zu/%zu  uniforms %zu/%zu",
+                        cola.programBinds, cola.programSkips, cola.vertexArrayBinds, cola.vertexArraySkips,
+                        cola.textureBinds, cola.textureSkips, cola.uniformSets, cola.uniformSkips);
+            ImGui::Checkbox("Niveles de detalle", &Model::levelOfDetail);
+            ImGui::SameLine();
+            ImGui::Checkbox("Transición con tramado", &Model::lodCrossfade);
+            ImGui::SliderFloat("Sesgo de LOD", &Model::lodBias, -2.0f, 4.0f, "%.1f");
+            ImGui::Text("LOD: mallas %zu/%zu/%zu/%zu, triángulos %zu/%zu/%zu/%zu (%zu de %zu en nivel 0), %zu en transición",
+                        lodEscena.meshes[0], lodEscena.meshes[1], lodEscena.meshes[2], lodEscena.meshes[3],
+                        lodEscena.triangles[0], lodEscena.triangles[1], lodEscena.triangles[2], lodEscena.triangles[3],
+                        lodEscena.totalTriangles(), lodEscena.fullTriangles, lodEscena.fading);
+            ImGui::Checkbox("Impostores", &Model::useImpostors);
+            ImGui::SliderFloat("Impostor desde (px)", &Model::impostorPixels, 8.0f, 512.0f, "%.0f");
+            ImGui::Text("Impostores: %zu de %zu clusters, %zu triángulos reemplazados",
+                        impostorEscena.drawn, impostorEscena.clusters, impostorEscena.triangles);
+            if (ciudad.ready())
+                ImGui::Text("Lista estática: %zu dibujos en %zu lotes", ciudad.get()->cachedDrawCount(), ciudad.get()->cachedBatchCount());
+            const GeometryArena& arena = GeometryArena::instance(formatoVertices);
+            ImGui::Text("Geometría compartida: %.1f / %.1f MB", arena.usedBytes() / (1024.0 * 1024.0),
+                        arena.capacityBytes() / (1024.0 * 1024.0));
+            ImGui::End();
+        }
+
         // Render de ImGui
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -588,6 +815,14 @@ int main() {
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        if (primerFrame) {
+            // Incluye construir el atlas de fuentes de ImGui y subirlo a la GPU
+            primerFrameTimer.stop();
+            primerFrame = false;
+            std::cout << "Primer frame en " << (glfwGetTime() - tiempoInicio) << " s" << std::endl;
+            perfil.markFirstInteractiveFrame();
+        }
     }
 
     // Limpieza de ImGui
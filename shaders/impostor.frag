@@ -0,0 +1,101 @@
+#version 330 core
+
+in vec3 Position;
+flat in vec3 Eye;
+flat in vec4 Sphere;
+flat in float Layer;
+flat in ivec2 Views[3];
+flat in vec3 ViewWeights;
+
+out vec4 FragColor;
+
+// Datos del frame, compartidos por todos los programas (ver FrameUniforms.h)
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Atlas del modelo (ver ImpostorAtlas.h), premultiplicados por la cobertura:
+// albedo y cobertura; normal del modelo en [0, 1] y profundidad de la vista
+uniform sampler2DArray impostorAlbedo;
+uniform sampler2DArray impostorNormalDepth;
+
+uniform samplerBuffer objects;
+uniform int object;
+
+uniform vec3 impostorUp;
+uniform vec3 impostorTangent;
+
+const int FRAMES = 8;   // ImpostorAtlas::FRAMES
+
+// Dirección desde la que se horneó una vista (la inversa de la codificación de impostor.vert)
+vec3 viewDirection(ivec2 frame, vec3 bitangent)
+{
+    vec2 uv = vec2(frame) / float(FRAMES - 1) * 2.0 - 1.0;
+    vec2 xz = vec2(uv.x + uv.y, uv.x - uv.y) * 0.5;
+    vec3 local = vec3(xz.x, 1.0 - abs(xz.x) - abs(xz.y), xz.y);
+    return normalize(impostorTangent * local.x + impostorUp * local.y + bitangent * local.z);
+}
+
+void main()
+{
+    vec3 center = Sphere.xyz;
+    float radius = Sphere.w;
+    vec3 ray = Position - Eye;
+    vec3 bitangent = cross(impostorTangent, impostorUp);
+
+    // Sin ramas: las derivadas de las tres lecturas tienen que valer en todo el cuadrado
+    vec4 albedo = vec4(0.0);
+    vec4 normalDepth = vec4(0.0);
+    vec3 surface = vec3(0.0);
+    for (int k = 0; k < 3; k++) {
+        vec3 direction = viewDirection(Views[k], bitangent);
+        // Ejes de la vista como los arma glm::lookAt al hornear
+        vec3 hint = abs(dot(direction, impostorUp)) > 0.999 ? bitangent : impostorUp;
+        vec3 right = normalize(cross(-direction, hint));
+        vec3 up = cross(right, -direction);
+
+        // El rayo del píxel contra el plano de la vista por el centro
+        float facing = dot(ray, direction);
+        vec3 hit = Eye + ray * (dot(center - Eye, direction) / min(facing, -1e-4));
+        vec2 uv = vec2(dot(hit - center, right), dot(hit - center, up)) / radius * 0.5 + 0.5;
+        float inside = facing < -1e-4 && all(greaterThanEqual(uv, vec2(0.0))) && all(lessThanEqual(uv, vec2(1.0))) ? 1.0 : 0.0;
+        vec3 coord = vec3((vec2(Views[k]) + clamp(uv, 0.0, 1.0)) / float(FRAMES), Layer);
+
+        float weight = ViewWeights[k] * inside;
+        vec4 a = texture(impostorAlbedo, coord);
+        vec4 nd = texture(impostorNormalDepth, coord);
+        albedo += weight * a;
+        normalDepth += weight * nd;
+        // Vista ortográfica: la superficie está sobre la dirección de la vista,
+        // a radius * (1 - 2 z) del plano
+        surface += weight * (a.a * hit + direction * radius * (a.a - 2.0 * nd.a));
+    }
+
+    float coverage = albedo.a;
+    if (coverage < 0.5)
+        discard;
+
+    int base = object * 7;
+    mat4 model = mat4(texelFetch(objects, base), texelFetch(objects, base + 1),
+                      texelFetch(objects, base + 2), texelFetch(objects, base + 3));
+    mat3 normalMatrix = mat3(texelFetch(objects, base + 4).xyz, texelFetch(objects, base + 5).xyz,
+                             texelFetch(objects, base + 6).xyz);
+
+    vec3 color = albedo.rgb / coverage;
+    vec3 norm = normalize(normalMatrix * (normalDepth.rgb / coverage * 2.0 - 1.0));
+    vec3 fragPos = vec3(model * vec4(surface / coverage, 1.0));
+
+    // Misma luz que model.frag sin mapas (difusa con mínimo, sin especular)
+    vec3 lightDir = normalize(lightPos.xyz - fragPos);
+    float diff = max(dot(norm, lightDir), 0.50);
+    FragColor = vec4(0.3 * color + diff * color, 1.0);
+
+    // La profundidad de la superficie y no la del cuadrado
+    vec4 clip = projection * view * vec4(fragPos, 1.0);
+    gl_FragDepth = clamp(clip.z / clip.w * 0.5 + 0.5, 0.0, 1.0);
+}
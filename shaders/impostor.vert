@@ -0,0 +1,83 @@
+#version 330 core
+
+// Impostor de un cluster (ver ImpostorAtlas.h): un cuadrado por instancia que
+// mira a la cámara, sin búfer de vértices (las esquinas salen de gl_VertexID,
+// en tira). También elige las tres vistas del atlas más cercanas a la
+// dirección desde la que se lo mira; impostor.frag las mezcla.
+
+// Datos del frame, compartidos por todos los programas (ver FrameUniforms.h)
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Por instancia
+layout(location = 0) in vec4 aSphere;   // centro y radio en el espacio del modelo
+layout(location = 1) in float aLayer;   // capa de los arreglos de texturas
+
+// Transformación de la ranura object (ver ObjectBuffer.h)
+uniform samplerBuffer objects;
+uniform int object;
+
+// Base del hemisferio de vistas: la vertical del modelo (ClusterGrid::up) y un eje del suelo
+uniform vec3 impostorUp;
+uniform vec3 impostorTangent;
+
+const int FRAMES = 8;   // ImpostorAtlas::FRAMES
+
+out vec3 Position;           // sobre el cuadrado, en el espacio del modelo
+flat out vec3 Eye;           // la cámara en el espacio del modelo
+flat out vec4 Sphere;
+flat out float Layer;
+flat out ivec2 Views[3];     // vistas del atlas (columna, fila)
+flat out vec3 ViewWeights;   // baricéntricas, suman 1
+
+void main()
+{
+    int base = object * 7;
+    mat4 model = mat4(texelFetch(objects, base), texelFetch(objects, base + 1),
+                      texelFetch(objects, base + 2), texelFetch(objects, base + 3));
+
+    Eye = vec3(inverse(model) * vec4(viewPos.xyz, 1.0));
+    Sphere = aSphere;
+    Layer = aLayer;
+    vec3 center = aSphere.xyz;
+    float radius = aSphere.w;
+    vec3 toEye = Eye - center;
+    float distance = max(length(toEye), 1e-4);
+    vec3 direction = toEye / distance;
+
+    // Codificación hemi-octaédrica de la dirección (desde abajo se usa el horizonte)
+    vec3 bitangent = cross(impostorTangent, impostorUp);
+    vec3 local = vec3(dot(direction, impostorTangent), max(dot(direction, impostorUp), 0.0), dot(direction, bitangent));
+    local /= max(abs(local.x) + local.y + abs(local.z), 1e-4);
+    vec2 grid = (vec2(local.x + local.z, local.x - local.z) * 0.5 + 0.5) * float(FRAMES - 1);
+    ivec2 cell = clamp(ivec2(floor(grid)), ivec2(0), ivec2(FRAMES - 2));
+    vec2 f = clamp(grid - vec2(cell), 0.0, 1.0);
+
+    // La celda se parte en dos triángulos por la diagonal
+    Views[0] = cell;
+    Views[1] = cell + ivec2(1, 1);
+    if (f.x > f.y) {
+        Views[2] = cell + ivec2(1, 0);
+        ViewWeights = vec3(1.0 - f.x, f.y, f.x - f.y);
+    } else {
+        Views[2] = cell + ivec2(0, 1);
+        ViewWeights = vec3(1.0 - f.y, f.x, f.y - f.x);
+    }
+
+    // En el plano por el centro, la silueta de la esfera en perspectiva es más
+    // grande que su radio
+    float size = radius / sqrt(max(1.0 - (radius * radius) / (distance * distance), 0.01));
+    vec3 hint = abs(dot(direction, impostorUp)) > 0.999 ? bitangent : impostorUp;
+    vec3 right = normalize(cross(hint, direction));
+    vec3 up = cross(direction, right);
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    Position = center + (right * corner.x + up * corner.y) * size;
+
+    gl_Position = projection * view * model * vec4(Position, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// Horneado de impostores (ver ImpostorAtlas.h): con model.vert y la ranura del
+// modelo en identidad, Normal queda en el espacio del modelo. Las dos salidas
+// se limpian a 0, así que el fondo queda sin cobertura en ambas texturas.
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+flat in vec4 Layers;   // x diffuse
+
+layout(location = 0) out vec4 Albedo;        // rgb y cobertura
+layout(location = 1) out vec4 NormalDepth;   // normal en [0, 1] y profundidad (ortográfica: lineal)
+
+uniform sampler2DArray texture_diffuse1;
+
+void main()
+{
+    Albedo = vec4(texture(texture_diffuse1, vec3(TexCoords, Layers.x)).rgb, 1.0);
+    NormalDepth = vec4(normalize(Normal) * 0.5 + 0.5, gl_FragCoord.z);
+}
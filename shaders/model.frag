@@ -3,33 +3,92 @@
 in vec2 TexCoords;
 in vec3 Normal;
 in vec3 FragPos;
+flat in vec4 Layers;   // x diffuse, y normal, z metallicRoughness, w emissive
+#ifdef LOD_FADE
+flat in float Fade;    // > 0 el nivel que entra, < 0 el que sale, 0 sin transición
+#endif
+#ifdef NORMAL_MAP
+in mat3 TBN;
+#endif
 
 out vec4 FragColor;
 
-uniform sampler2D texture_diffuse1;
+// Las texturas del mismo tamaño y formato comparten un arreglo; la malla dice la capa
+// Cada variante (ver ShaderVariants.h) declara solo los samplers que usa
+uniform sampler2DArray texture_diffuse1;
+#ifdef NORMAL_MAP
+uniform sampler2DArray texture_normal1;
+#endif
+#ifdef SPECULAR
+uniform sampler2DArray texture_metallicRoughness1;
+#endif
+#ifdef EMISSIVE
+uniform sampler2DArray texture_emissive1;
+#endif
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
+// Datos del frame, compartidos por todos los programas (ver FrameUniforms.h)
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+#ifdef LOD_FADE
+// Umbral de Bayer 4x4 en (0, 1): los dos niveles de una transición se reparten
+// los píxeles sin dejar huecos ni dibujar dos veces el mismo
+float ditherThreshold(vec2 fragCoord)
+{
+    const int BAYER[16] = int[16](0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (float(BAYER[p.y * 4 + p.x]) + 0.5) / 16.0;
+}
+#endif
 
 void main()
 {
+#ifdef LOD_FADE
+    if (Fade != 0.0 && (Fade > 0.0) != (ditherThreshold(gl_FragCoord.xy) < abs(Fade)))
+        discard;
+#endif
+
     // Propiedades del material
-    vec3 color = texture(texture_diffuse1, TexCoords).rgb;
+    vec3 color = texture(texture_diffuse1, vec3(TexCoords, Layers.x)).rgb;
+
+#ifdef UNLIT
+    vec3 result = color;
+#else
     vec3 ambient = 0.3 * color;
 
     // Difusa
+#ifdef NORMAL_MAP
+    // z se reconstruye de xy: las horneadas en BC5 solo guardan dos canales (b = 0)
+    vec2 xy = texture(texture_normal1, vec3(TexCoords, Layers.y)).rg * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+    vec3 norm = normalize(TBN * tangentNormal);
+#else
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+#endif
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.50);
     vec3 diffuse = diff * color;
 
-    // Especular
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 result = ambient + diffuse;
+
+    // Especular: solo con mapa de metallicRoughness (rugosidad en el canal g)
+#ifdef SPECULAR
+    float roughness = texture(texture_metallicRoughness1, vec3(TexCoords, Layers.z)).g;
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = lightColor * spec * 0.5;
+    result += lightColor.rgb * spec * 0.5 * (1.0 - roughness);
+#endif
+#endif
 
-    vec3 result = ambient + diffuse + specular;
+#ifdef EMISSIVE
+    result += texture(texture_emissive1, vec3(TexCoords, Layers.w)).rgb;
+#endif
     FragColor = vec4(result, 1.0);
 }
@@ -3,21 +3,82 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoords;
+#ifdef NORMAL_MAP
+layout(location = 3) in vec3 aTangent;
+layout(location = 4) in vec3 aBitangent;
+#endif
 
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
+#ifdef NORMAL_MAP
+out mat3 TBN;
+#endif
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Datos del frame, compartidos por todos los programas (ver FrameUniforms.h)
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Por dibujo (constantes o de a una por comando en multi-draw, ver DrawAttrib).
+// Vértices cuantizados: aPos en [0,1] dentro del AABB de la malla y la normal
+// octaédrica en aNormal.xy. Con vértices de floats scale = 1, offset = 0.
+layout(location = 5) in vec3 aDrawScale;
+layout(location = 6) in vec3 aDrawOffset;
+layout(location = 7) in vec4 aDrawLayers;   // capas de diffuse, normal, metallicRoughness, emissive
+layout(location = 8) in float aDrawObject;
+#ifdef LOD_FADE
+layout(location = 9) in float aDrawFade;    // transición entre niveles de detalle (ver LodSelector::fade)
+#endif
+
+// Por objeto (ver ObjectBuffer.h): 7 texels desde aDrawObject * 7,
+// la matriz model y las columnas de su matriz normal
+uniform samplerBuffer objects;
+
+flat out vec4 Layers;
+#ifdef LOD_FADE
+flat out float Fade;
+#endif
+
+uniform bool octNormals;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(e.yx)) * signs;
+    }
+    return normalize(n);
+}
 
 void main()
 {
     TexCoords = aTexCoords;
+    Layers = aDrawLayers;
+#ifdef LOD_FADE
+    Fade = aDrawFade;
+#endif
+
+    vec3 position = aPos * aDrawScale + aDrawOffset;
+    vec3 normal = octNormals ? decodeOctahedral(aNormal.xy) : aNormal;
+
+    int base = int(aDrawObject) * 7;
+    mat4 model = mat4(texelFetch(objects, base), texelFetch(objects, base + 1),
+                      texelFetch(objects, base + 2), texelFetch(objects, base + 3));
+    mat3 normalMatrix = mat3(texelFetch(objects, base + 4).xyz, texelFetch(objects, base + 5).xyz,
+                             texelFetch(objects, base + 6).xyz);
 
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = normalMatrix * normal;
+#ifdef NORMAL_MAP
+    TBN = mat3(normalize(mat3(model) * aTangent), normalize(mat3(model) * aBitangent), normalize(Normal));
+#endif
 
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,8 @@
+#version 330 core
+out vec4 FragColor;
+
+// Sin color (glColorMask apagado): solo cuenta si algún fragmento pasa la profundidad
+void main()
+{
+    FragColor = vec4(1.0);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+
+// Caja de una consulta de oclusión (ver OcclusionQueries.h): 36 vértices sin
+// búfer, las esquinas salen de gl_VertexID (bit 0 = x, 1 = y, 2 = z)
+
+// Datos del frame, compartidos por todos los programas (ver FrameUniforms.h)
+layout(std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Transformación de la ranura object (ver ObjectBuffer.h)
+uniform samplerBuffer objects;
+uniform int object;
+
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+const int CORNERS[36] = int[36](
+    0, 2, 6,  0, 6, 4,    // -x
+    1, 5, 7,  1, 7, 3,    // +x
+    0, 4, 5,  0, 5, 1,    // -y
+    2, 3, 7,  2, 7, 6,    // +y
+    0, 1, 3,  0, 3, 2,    // -z
+    4, 6, 7,  4, 7, 5     // +z
+);
+
+void main()
+{
+    int corner = CORNERS[gl_VertexID];
+    vec3 position = mix(boxMin, boxMax, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+
+    int base = object * 7;
+    mat4 model = mat4(texelFetch(objects, base), texelFetch(objects, base + 1),
+                      texelFetch(objects, base + 2), texelFetch(objects, base + 3));
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}